@@ -131,7 +131,7 @@ bool Manager::loadConditions()
     return !_conditions.empty();
 }
 
-bool Manager::conditionMatch(const sdbusplus::object_path& objectPath,
+bool Manager::conditionMatch(std::string_view objectPath,
                              const Object& object)
 {
     fs::path foundPath;
@@ -142,20 +142,13 @@ bool Manager::conditionMatch(const sdbusplus::object_path& objectPath,
             continue;
         }
 
-        auto interface = std::find_if(
-            object.begin(), object.end(), [&condition](const auto& i) {
-                return i.first == condition.interface;
-            });
+        auto interface = object.find(condition.interface);
         if (interface == object.end())
         {
             continue;
         }
 
-        auto property =
-            std::find_if(interface->second.begin(), interface->second.end(),
-                         [&condition](const auto& p) {
-                             return condition.property == p.first;
-                         });
+        auto property = interface->second.find(condition.property);
         if (property == interface->second.end())
         {
             continue;
@@ -229,7 +222,7 @@ void Manager::load(const nlohmann::json& json)
             path = root + path;
         }
 
-        auto& assocEndpoints = _associations[path];
+        auto& assocEndpoints = _associations[Interned(path)];
 
         for (const auto& endpoint : jsonAssoc.at("endpoints"))
         {
@@ -237,9 +230,13 @@ void Manager::load(const nlohmann::json& json)
             std::string rtype = endpoint.at("types").at("rType");
             throwIfZero(ftype.size());
             throwIfZero(rtype.size());
-            Types types{std::move(ftype), std::move(rtype)};
+            Types types{Interned(ftype), Interned(rtype)};
 
-            Paths paths = endpoint.at("paths");
+            Paths paths;
+            for (const auto& p : endpoint.at("paths"))
+            {
+                paths.emplace_back(p.get<std::string>());
+            }
             throwIfZero(paths.size());
             assocEndpoints.emplace_back(std::move(types), std::move(paths));
         }
@@ -255,13 +252,16 @@ void Manager::createAssociations(const std::string& objectPath,
         return;
     }
 
-    if (std::find(_handled.begin(), _handled.end(), objectPath) !=
+    // The configured paths are interned, so handled paths compare as
+    // pointers.
+    const auto& forwardPath = endpoints->first;
+    if (std::find(_handled.begin(), _handled.end(), forwardPath) !=
         _handled.end())
     {
         return;
     }
 
-    _handled.push_back(objectPath);
+    _handled.push_back(forwardPath);
 
     for (const auto& endpoint : endpoints->second)
     {
@@ -273,14 +273,14 @@ void Manager::createAssociations(const std::string& objectPath,
             const auto& forwardType = std::get<forwardTypePos>(types);
             const auto& reverseType = std::get<reverseTypePos>(types);
 
-            createAssociation(objectPath, forwardType, endpointPath,
+            createAssociation(forwardPath, forwardType, endpointPath,
                               reverseType, deferSignal);
         }
     }
 }
 
 void Manager::createAssociation(
-    const std::string& forwardPath, const std::string& forwardType,
+    Interned forwardPath, const std::string& forwardType,
     const std::string& reversePath, const std::string& reverseType,
     bool deferSignal)
 {
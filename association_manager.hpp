@@ -2,6 +2,7 @@
 
 #include "config.h"
 
+#include "intern.hpp"
 #include "types.hpp"
 
 #include <nlohmann/json.hpp>
@@ -9,6 +10,7 @@
 
 #include <any>
 #include <filesystem>
+#include <string_view>
 
 namespace phosphor
 {
@@ -21,20 +23,20 @@ namespace associations
 
 static constexpr auto forwardTypePos = 0;
 static constexpr auto reverseTypePos = 1;
-using Types = std::tuple<std::string, std::string>;
-using Paths = std::vector<std::string>;
+using Types = std::tuple<Interned, Interned>;
+using Paths = std::vector<Interned>;
 
 static constexpr auto typesPos = 0;
 static constexpr auto pathsPos = 1;
 using EndpointsEntry = std::vector<std::tuple<Types, Paths>>;
 
-using AssociationMap = std::map<std::string, EndpointsEntry>;
+using AssociationMap = std::map<Interned, EndpointsEntry, std::less<>>;
 
 using AssociationObject = sdbusplus::server::object_t<
     sdbusplus::xyz::openbmc_project::Association::server::Definitions>;
 
 using AssociationIfaceMap =
-    std::map<std::string, std::unique_ptr<AssociationObject>>;
+    std::map<Interned, std::unique_ptr<AssociationObject>, std::less<>>;
 
 /**
  * @class Manager
@@ -146,8 +148,7 @@ class Manager
      *
      * @return bool - If the object matched a condition
      */
-    bool conditionMatch(const sdbusplus::object_path& objectPath,
-                        const Object& object);
+    bool conditionMatch(std::string_view objectPath, const Object& object);
 
     /**
      * @brief Checks if a pending condition is satisfied based on if the
@@ -186,8 +187,7 @@ class Manager
      * @param[in] deferSignal - whether or not to send a Properties or
      *                          ObjectManager signal
      */
-    void createAssociation(const std::string& forwardPath,
-                           const std::string& forwardType,
+    void createAssociation(Interned forwardPath, const std::string& forwardType,
                            const std::string& reversePath,
                            const std::string& reverseType, bool deferSignal);
 
@@ -224,7 +224,7 @@ class Manager
     /**
      * A list of the inventory association paths that have already been handled.
      */
-    std::vector<std::string> _handled;
+    std::vector<Interned> _handled;
 
     /**
      * @brief Conditions that specify when an associations file is valid.
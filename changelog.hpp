@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+/** @class ChangeLog
+ *  @brief A bounded record of which interfaces changed in which
+ *      generation.
+ *
+ *  Generations count up as changes are recorded.  Once the log is full
+ *  the oldest changes are dropped, and asking for changes since a
+ *  generation before them fails, so the caller knows to start over.
+ *  Each log has a random stream ID, so generations from a previous log,
+ *  such as one kept by a client across a restart, can be told apart.
+ */
+class ChangeLog
+{
+  public:
+    /** @brief Changed interface names, by object path. */
+    using Changes =
+        std::map<std::string, std::set<std::string, std::less<>>, std::less<>>;
+
+    ChangeLog() = delete;
+    ChangeLog(const ChangeLog&) = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+    ChangeLog(ChangeLog&&) = delete;
+    ChangeLog& operator=(ChangeLog&&) = delete;
+    ~ChangeLog() = default;
+
+    /** @brief Construct a change log.
+     *
+     *  @param[in] limit - The most changes to keep.
+     */
+    explicit ChangeLog(std::size_t limit) :
+        _stream(std::random_device{}() |
+                std::uint64_t(std::random_device{}()) << 32),
+        _limit(limit)
+    {}
+
+    /** @brief The stream ID. */
+    std::uint64_t stream() const noexcept
+    {
+        return _stream;
+    }
+
+    /** @brief Record a change.
+     *
+     *  Generations must be recorded in increasing order; several changes
+     *  can share one.
+     *
+     *  @param[in] generation - The generation of the change.
+     *  @param[in] path - The object path.
+     *  @param[in] interface - The interface added, changed or removed.
+     */
+    void record(std::uint64_t generation, std::string_view path,
+                std::string_view interface)
+    {
+        _changes.emplace_back(generation, std::string(path),
+                              std::string(interface));
+        while (_changes.size() > _limit)
+        {
+            _floor = _changes.front().generation;
+            _changes.pop_front();
+        }
+    }
+
+    /** @brief The interfaces changed after a generation.
+     *
+     *  @param[in] generation - The generation the caller is up to date
+     *      with.
+     *
+     *  @returns The changes, or nullopt if some have been dropped.
+     */
+    std::optional<Changes> since(std::uint64_t generation) const
+    {
+        if (generation < _floor)
+        {
+            return std::nullopt;
+        }
+
+        auto first = std::ranges::partition_point(
+            _changes, [generation](const auto& change) {
+                return change.generation <= generation;
+            });
+
+        Changes changes;
+        for (auto it = first; it != _changes.end(); ++it)
+        {
+            auto entry = changes.find(it->path);
+            if (entry == changes.end())
+            {
+                entry = changes.emplace(it->path, Changes::mapped_type{})
+                            .first;
+            }
+            entry->second.emplace(it->interface);
+        }
+        return changes;
+    }
+
+  private:
+    struct Change
+    {
+        std::uint64_t generation;
+        std::string path;
+        std::string interface;
+    };
+
+    /** @brief Identifies this log's generations. */
+    std::uint64_t _stream;
+
+    /** @brief The most changes to keep. */
+    std::size_t _limit;
+
+    /** @brief The latest generation with dropped changes. */
+    std::uint64_t _floor = 0;
+
+    /** @brief The changes kept, oldest first. */
+    std::deque<Change> _changes;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -0,0 +1,333 @@
+#include "compact.hpp"
+
+#include "extensions.hpp"
+
+#include <nlohmann/json.hpp>
+#include <sdbusplus/exception.hpp>
+#include <systemd/sd-bus.h>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+namespace compact
+{
+namespace
+{
+/** @brief Throw if an sd-bus call failed. */
+void check(int r, const char* what)
+{
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, what);
+    }
+}
+
+/** @brief The length of the first complete type in a signature. */
+std::size_t typeLength(std::string_view signature)
+{
+    if (signature.empty())
+    {
+        throw std::invalid_argument("Incomplete signature");
+    }
+    if (signature.front() == 'a')
+    {
+        return 1 + typeLength(signature.substr(1));
+    }
+    if (signature.front() != '(' && signature.front() != '{')
+    {
+        return 1;
+    }
+
+    auto close = signature.front() == '(' ? ')' : '}';
+    std::size_t n = 1;
+    while (n < signature.size() && signature[n] != close)
+    {
+        n += typeLength(signature.substr(n));
+    }
+    if (n >= signature.size())
+    {
+        throw std::invalid_argument("Incomplete signature");
+    }
+    return n + 1;
+}
+
+template <typename T>
+void appendBasic(sd_bus_message* m, char type, const T& value)
+{
+    check(sd_bus_message_append_basic(m, type, &value),
+          "sd_bus_message_append_basic");
+}
+
+/** @brief Append a value described as Fixed::value describes it.
+ *
+ *  @param[in] m - The message.
+ *  @param[in] type - The signature of a single complete type.
+ *  @param[in] value - The value.
+ */
+void appendJson(sd_bus_message* m, std::string_view type,
+                const nlohmann::json& value)
+{
+    auto open = [m](char container, std::string_view contents) {
+        check(sd_bus_message_open_container(m, container,
+                                            std::string(contents).c_str()),
+              "sd_bus_message_open_container");
+    };
+    auto close = [m]() {
+        check(sd_bus_message_close_container(m),
+              "sd_bus_message_close_container");
+    };
+
+    switch (type.front())
+    {
+        case 'b':
+            // sd-bus reads booleans as int.
+            return appendBasic(m, 'b', int{value.get<bool>()});
+        case 'y':
+            return appendBasic(m, 'y', value.get<std::uint8_t>());
+        case 'n':
+            return appendBasic(m, 'n', value.get<std::int16_t>());
+        case 'q':
+            return appendBasic(m, 'q', value.get<std::uint16_t>());
+        case 'i':
+            return appendBasic(m, 'i', value.get<std::int32_t>());
+        case 'u':
+            return appendBasic(m, 'u', value.get<std::uint32_t>());
+        case 'x':
+            return appendBasic(m, 'x', value.get<std::int64_t>());
+        case 't':
+            return appendBasic(m, 't', value.get<std::uint64_t>());
+        case 'd':
+            // NaN and the infinities are written as strings.
+            return appendBasic(
+                m, 'd',
+                value.is_string()
+                    ? std::strtod(
+                          value.get_ref<const std::string&>().c_str(), nullptr)
+                    : value.get<double>());
+        case 's':
+        case 'o':
+        case 'g':
+            check(sd_bus_message_append_basic(
+                      m, type.front(),
+                      value.get_ref<const std::string&>().c_str()),
+                  "sd_bus_message_append_basic");
+            return;
+        case 'a':
+        {
+            auto element = type.substr(1);
+            open('a', element);
+            for (const auto& e : value)
+            {
+                if (element.front() != '{')
+                {
+                    appendJson(m, element, e);
+                    continue;
+                }
+                auto entry = element.substr(1, element.size() - 2);
+                open('e', entry);
+                appendJson(m, entry.substr(0, 1), e.at(0));
+                appendJson(m, entry.substr(1), e.at(1));
+                close();
+            }
+            close();
+            return;
+        }
+        case '(':
+        {
+            auto members = type.substr(1, type.size() - 2);
+            open('r', members);
+            for (const auto& e : value)
+            {
+                auto n = typeLength(members);
+                appendJson(m, members.substr(0, n), e);
+                members.remove_prefix(n);
+            }
+            close();
+            return;
+        }
+        case 'v':
+        {
+            const auto& signature = value.at(0).get_ref<const std::string&>();
+            open('v', signature);
+            appendJson(m, signature, value.at(1));
+            close();
+            return;
+        }
+        default:
+            throw std::invalid_argument("Unsupported signature " +
+                                        std::string(type));
+    }
+}
+} // namespace
+
+int Values::get(sd_bus* /* bus */, const char* /* path */,
+                const char* /* interface */, const char* property,
+                sd_bus_message* reply, void* userdata, sd_bus_error* error)
+{
+    return handleMethod(reply, error, [&](auto& m) {
+        const auto& values = *static_cast<const Values*>(userdata);
+        std::visit([&](const auto& v) { m.append(v); },
+                   values.getPropertyByName(property));
+    });
+}
+
+int Values::set(sd_bus* bus, const char* path, const char* interface,
+                const char* property, sd_bus_message* value, void* userdata,
+                sd_bus_error* error)
+{
+    return handleMethod(value, error, [&](auto& m) {
+        auto& values = *static_cast<Values*>(userdata);
+
+        // sd-bus checked the signature against the vtable, so reading
+        // into the default value reads the right type.
+        auto i = values.position(property);
+        auto v = values._info.properties[i].init;
+        std::visit([&](auto& x) { m.read(x); }, v);
+        if (values.getPropertyByName(property) == v)
+        {
+            return;
+        }
+        if (!values.valid(i, v))
+        {
+            throw sdbusplus::xyz::openbmc_project::Common::Error::
+                InvalidArgument();
+        }
+
+        // The slot sd-bus is dispatching is the interface's fallback
+        // vtable, whose context leads back to the server.
+        const auto* fallback = static_cast<const Server::Fallback*>(
+            sd_bus_slot_get_userdata(sd_bus_get_current_slot(bus)));
+        if (fallback && fallback->server->_write)
+        {
+            fallback->server->_write(path, fallback->interface, property,
+                                     std::move(v));
+            return;
+        }
+        values.setPropertyByName(property, std::move(v));
+        check(sd_bus_emit_properties_changed(bus, path, interface, property,
+                                             nullptr),
+              "sd_bus_emit_properties_changed");
+    });
+}
+
+int Values::getFixed(sd_bus* /* bus */, const char* /* path */,
+                     const char* /* interface */, const char* property,
+                     sd_bus_message* reply, void* userdata,
+                     sd_bus_error* error)
+{
+    return handleMethod(reply, error, [&](auto&) {
+        const auto& values = *static_cast<const Values*>(userdata);
+        auto it = std::ranges::find_if(
+            values._info.fixed, [property](const auto& f) {
+                return std::string_view(f.name) == property;
+            });
+        if (it == values._info.fixed.end())
+        {
+            throw sdbusplus::xyz::openbmc_project::Common::Error::
+                InvalidArgument();
+        }
+        appendJson(reply, it->signature, nlohmann::json::parse(it->value));
+    });
+}
+
+Server::Server(sdbusplus::bus_t& bus, const char* root,
+               std::span<const InterfaceInfo* const> interfaces, Find&& find,
+               Enumerate&& enumerate, Write&& write) :
+    _find(std::move(find)), _enumerate(std::move(enumerate)),
+    _write(std::move(write))
+{
+    // sd-bus keeps pointers to the contexts, so they can't move.
+    _fallbacks.reserve(interfaces.size());
+    for (std::size_t i = 0; i < interfaces.size(); ++i)
+    {
+        _fallbacks.push_back({this, i});
+        sd_bus_slot* slot = nullptr;
+        check(sd_bus_add_fallback_vtable(bus.get(), &slot, root,
+                                         interfaces[i]->name,
+                                         interfaces[i]->vtable, findObject,
+                                         &_fallbacks.back()),
+              "sd_bus_add_fallback_vtable");
+        _slots.emplace_back(slot);
+    }
+
+    sd_bus_slot* slot = nullptr;
+    check(sd_bus_add_node_enumerator(bus.get(), &slot, root, enumerateObjects,
+                                     this),
+          "sd_bus_add_node_enumerator");
+    _slots.emplace_back(slot);
+}
+
+int Server::findObject(sd_bus* /* bus */, const char* path,
+                       const char* /* interface */, void* userdata,
+                       void** found, sd_bus_error* error)
+{
+    const auto& fallback = *static_cast<const Fallback*>(userdata);
+    try
+    {
+        auto values = fallback.server->_find(path, fallback.interface);
+        if (!values)
+        {
+            return 0;
+        }
+        *found = values;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_FAILED, e.what());
+    }
+}
+
+int Server::enumerateObjects(sd_bus* /* bus */, const char* prefix,
+                             void* userdata, char*** nodes,
+                             sd_bus_error* error)
+{
+    const auto& server = *static_cast<const Server*>(userdata);
+    std::vector<std::string> paths;
+    try
+    {
+        paths = server._enumerate(prefix);
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_FAILED, e.what());
+    }
+
+    // sd-bus takes ownership of the list, and frees it with free().
+    auto strv = static_cast<char**>(std::calloc(paths.size() + 1,
+                                                sizeof(char*)));
+    if (!strv)
+    {
+        return -ENOMEM;
+    }
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        strv[i] = strdup(paths[i].c_str());
+        if (!strv[i])
+        {
+            for (std::size_t j = 0; j < i; ++j)
+            {
+                std::free(strv[j]);
+            }
+            std::free(strv);
+            return -ENOMEM;
+        }
+    }
+    *nodes = strv;
+    return 0;
+}
+
+} // namespace compact
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
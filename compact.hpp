@@ -0,0 +1,504 @@
+#pragma once
+
+#include "config.h"
+
+#include "interface_ops.hpp"
+#include "intern.hpp"
+#include "types.hpp"
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/slot.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+namespace compact
+{
+
+class Values;
+
+/** @brief A property of an interface kept in the compact store. */
+struct Property
+{
+    /** @brief The property name. */
+    const char* name;
+
+    /** @brief The default value, which also sets the property type. */
+    InterfaceVariantType init;
+
+    /** @brief For enumerations, the DBus names of the values in the
+     *      order they are declared.  Enumerations are kept as strings.
+     */
+    std::span<const char* const> enumeration;
+};
+
+/** @brief A property of a type the compact store can't keep, such as a
+ *      double or an array of enumerations.
+ *
+ *  It is served read-only with its default value, and Notify can't set
+ *  it.
+ */
+struct Fixed
+{
+    /** @brief The property name. */
+    const char* name;
+
+    /** @brief The DBus signature. */
+    const char* signature;
+
+    /** @brief The default value as JSON: arrays for arrays and structs,
+     *      [key, value] pairs for dictionaries, [signature, value] for
+     *      variants, and strings for doubles that aren't finite.
+     */
+    const char* value;
+};
+
+/** @brief An interface kept in the compact store, emitted by pimgen. */
+struct InterfaceInfo
+{
+    /** @brief The DBus interface name. */
+    const char* name;
+
+    /** @brief The properties, in the order they are kept. */
+    std::span<const Property> properties;
+
+    /** @brief The vtable registered for the interface, with Values::get
+     *      and Values::set as the property callbacks.
+     */
+    const sdbusplus::vtable_t* vtable;
+
+    /** @brief Access the values held by an interface holder. */
+    Values& (*values)(InterfaceHolder&);
+
+    /** @brief The properties served with their default values, with
+     *      Values::getFixed as the property callback.
+     */
+    std::span<const Fixed> fixed = {};
+};
+
+/** @class Values
+ *  @brief The property values of one interface of one object.
+ *
+ *  A stand-in for an sdbusplus server binding that registers nothing
+ *  with sd-bus.  DBus requests reach it through the fallback vtable
+ *  Server registers for the interface, and signals are left to the
+ *  inventory manager, which only ever sets properties with signals
+ *  skipped.  Set requests are handed to the Server's writer.
+ */
+class Values
+{
+  public:
+    Values() = delete;
+    Values(const Values&) = delete;
+    Values& operator=(const Values&) = delete;
+    Values(Values&&) = delete;
+    Values& operator=(Values&&) = delete;
+    ~Values() = default;
+
+    /** @brief Construct the default values of an interface. */
+    explicit Values(const InterfaceInfo& info) : _info(info)
+    {
+        _values.reserve(info.properties.size());
+        for (const auto& p : info.properties)
+        {
+            _values.push_back(store(p.init));
+        }
+    }
+
+    /** @brief The interface. */
+    const InterfaceInfo& info() const noexcept
+    {
+        return _info;
+    }
+
+    /** @brief The position of a property, or the property count if
+     *      there is no such property.
+     */
+    std::size_t position(std::string_view name) const noexcept
+    {
+        std::size_t i = 0;
+        while (i < _info.properties.size() && _info.properties[i].name != name)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    /** @brief Read a property.
+     *
+     *  As with the bindings, an unknown property reads as a default
+     *  constructed value.
+     */
+    InterfaceVariantType getPropertyByName(const std::string& name) const
+    {
+        auto i = position(name);
+        if (i == _values.size())
+        {
+            return {};
+        }
+        return view(_values[i],
+                    [](const auto& v) -> InterfaceVariantType { return v; });
+    }
+
+    /** @brief Set a property.
+     *
+     *  Unknown properties, values of the wrong type and unknown
+     *  enumeration values are ignored, as the bindings ignore them.
+     *
+     *  @returns Whether the property was set.
+     */
+    bool setPropertyByName(const std::string& name, InterfaceVariantType value,
+                           bool /* skipSignal */ = true)
+    {
+        auto i = position(name);
+        if (i == _values.size() || !valid(i, value))
+        {
+            return false;
+        }
+        _values[i] = store(std::move(value));
+        return true;
+    }
+
+    /** @brief Persist the values.
+     *
+     *  The archive has the layout the cereal functions pimgen writes for
+     *  the bindings use, so inventory persisted by either can be
+     *  restored by the other.  Enumerations are written by position.
+     */
+    template <class Archive>
+    void save(Archive& a) const
+    {
+        a(cereal::make_nvp("cereal_class_version",
+                           std::uint32_t{CLASS_VERSION}));
+        for (std::size_t i = 0; i < _values.size(); ++i)
+        {
+            const auto& p = _info.properties[i];
+            if (!p.enumeration.empty())
+            {
+                a(cereal::make_nvp(p.name, static_cast<int>(ordinal(i))));
+                continue;
+            }
+            view(_values[i],
+                 [&](const auto& v) { a(cereal::make_nvp(p.name, v)); });
+        }
+    }
+
+    /** @brief Restore persisted values.
+     *
+     *  Properties missing from the archive keep their values, as do all
+     *  properties if the archive predates named values.
+     */
+    template <class Archive>
+    void load(Archive& a)
+    {
+        std::uint32_t version = 0;
+        a(cereal::make_nvp("cereal_class_version", version));
+        if (version < versionWithNvp)
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i < _values.size(); ++i)
+        {
+            const auto& p = _info.properties[i];
+            try
+            {
+                if (!p.enumeration.empty())
+                {
+                    int n = 0;
+                    a(cereal::make_nvp(p.name, n));
+                    if (n >= 0 &&
+                        static_cast<std::size_t>(n) < p.enumeration.size())
+                    {
+                        _values[i] = store(std::string(p.enumeration[n]));
+                    }
+                    continue;
+                }
+                auto value = p.init;
+                std::visit([&](auto& v) { a(cereal::make_nvp(p.name, v)); },
+                           value);
+                _values[i] = store(std::move(value));
+            }
+            catch (const cereal::Exception&)
+            {
+                // Ignore any exceptions, property value stays as is
+            }
+        }
+    }
+
+    /** @brief sd-bus property get callback. */
+    static int get(sd_bus* bus, const char* path, const char* interface,
+                   const char* property, sd_bus_message* reply,
+                   void* userdata, sd_bus_error* error);
+
+    /** @brief sd-bus property set callback. */
+    static int set(sd_bus* bus, const char* path, const char* interface,
+                   const char* property, sd_bus_message* value,
+                   void* userdata, sd_bus_error* error);
+
+    /** @brief sd-bus property get callback for Fixed properties. */
+    static int getFixed(sd_bus* bus, const char* path, const char* interface,
+                        const char* property, sd_bus_message* reply,
+                        void* userdata, sd_bus_error* error);
+
+  private:
+    /** @brief The archive version cereal NVPs were first used in. */
+    static constexpr std::uint32_t versionWithNvp = 2;
+
+#ifdef INTERN_VALUES
+    /** @brief A value as kept.
+     *
+     *  Strings, such as Manufacturer and Model, repeat across objects,
+     *  so they are interned.  The alternatives are otherwise those of
+     *  InterfaceVariantType, in the same order.
+     */
+    using Stored = std::variant<bool, size_t, int64_t, uint16_t, Interned,
+                                std::vector<uint8_t>, std::vector<std::string>>;
+#else
+    using Stored = InterfaceVariantType;
+#endif
+
+    /** @brief Convert a value to the way it is kept. */
+    static Stored store(InterfaceVariantType value)
+    {
+        return std::visit(
+            []<typename T>(T&& v) -> Stored {
+                if constexpr (std::is_same_v<std::decay_t<T>, std::string> &&
+                              !std::is_same_v<Stored, InterfaceVariantType>)
+                {
+                    return Interned(v);
+                }
+                else
+                {
+                    return std::forward<T>(v);
+                }
+            },
+            std::move(value));
+    }
+
+    /** @brief Call a function with a kept value, as the alternative of
+     *      InterfaceVariantType it was converted from.
+     */
+    template <typename F>
+    static auto view(const Stored& value, F&& f)
+        -> std::invoke_result_t<F&, const bool&>
+    {
+        return std::visit(
+            [&]<typename T>(const T& v)
+                -> std::invoke_result_t<F&, const bool&> {
+                if constexpr (std::is_same_v<T, Interned>)
+                {
+                    return f(v.str());
+                }
+                else
+                {
+                    return f(v);
+                }
+            },
+            value);
+    }
+
+    /** @brief Test that a value can be held by a property. */
+    bool valid(std::size_t i, const InterfaceVariantType& value) const
+    {
+        const auto& p = _info.properties[i];
+        if (value.index() != p.init.index())
+        {
+            return false;
+        }
+        if (p.enumeration.empty())
+        {
+            return true;
+        }
+        const auto& s = std::get<std::string>(value);
+        for (auto e : p.enumeration)
+        {
+            if (s == e)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** @brief The position of an enumeration value in its declaration. */
+    std::size_t ordinal(std::size_t i) const
+    {
+        const auto& p = _info.properties[i];
+        auto s = view(_values[i], []<typename T>(const T& v) {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                return std::string_view(v);
+            }
+            else
+            {
+                return std::string_view();
+            }
+        });
+        std::size_t n = 0;
+        while (n < p.enumeration.size() && s != p.enumeration[n])
+        {
+            ++n;
+        }
+        return n < p.enumeration.size() ? n : 0;
+    }
+
+    const InterfaceInfo& _info;
+    std::vector<Stored> _values;
+};
+
+/** @class Binding
+ *  @brief The compact store type of an interface with properties.
+ *
+ *  Has the constructors and property accessors the interface ops use
+ *  with sdbusplus server bindings, so pimgen can use it in their place.
+ *
+ *  @tparam I - The interface.
+ */
+template <const InterfaceInfo& I>
+class Binding : public Values
+{
+  public:
+    using PropertiesVariant = InterfaceVariantType;
+
+    Binding(sdbusplus::bus_t&, const char*) : Values(I) {}
+
+    Binding(sdbusplus::bus_t&, const char*,
+            const std::map<std::string, PropertiesVariant>& values,
+            bool skipSignal) : Values(I)
+    {
+        for (const auto& [name, value] : values)
+        {
+            setPropertyByName(name, value, skipSignal);
+        }
+    }
+
+    template <class Archive>
+    void save(Archive& a) const
+    {
+        Values::save(a);
+    }
+
+    template <class Archive>
+    void load(Archive& a)
+    {
+        Values::load(a);
+    }
+};
+
+/** @class Marker
+ *  @brief The compact store type of an interface without properties.
+ *
+ *  Like the bindings of such interfaces, it has no PropertiesVariant,
+ *  so the interface ops persist it as an empty file.
+ *
+ *  @tparam I - The interface.
+ */
+template <const InterfaceInfo& I>
+class Marker : public Values
+{
+  public:
+    Marker(sdbusplus::bus_t&, const char*) : Values(I) {}
+};
+
+/** @class Server
+ *  @brief Serves the compact store over DBus.
+ *
+ *  Registers one fallback vtable per interface at the inventory root,
+ *  and a node enumerator, so sd-bus handles Get, GetAll, Set,
+ *  introspection and ObjectManager requests for every object without
+ *  a registration per object.
+ */
+class Server
+{
+  public:
+    /** @brief Look up the values of an interface of an object.
+     *
+     *  Called with the absolute object path and the interface's
+     *  position in the interfaces passed to the constructor.  Returns
+     *  nullptr if the object does not implement the interface.
+     */
+    using Find = std::function<Values*(std::string_view, std::size_t)>;
+
+    /** @brief List the absolute paths of the objects below a path. */
+    using Enumerate = std::function<std::vector<std::string>(std::string_view)>;
+
+    /** @brief Apply a DBus Set request.
+     *
+     *  Called with the absolute object path, the interface's position,
+     *  the property name and a value already checked against the
+     *  property.  It is left to set the value and send
+     *  PropertiesChanged.
+     */
+    using Write = std::function<void(std::string_view, std::size_t,
+                                     const char*, InterfaceVariantType&&)>;
+
+    Server() = delete;
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+    Server(Server&&) = delete;
+    Server& operator=(Server&&) = delete;
+    ~Server() = default;
+
+    /** @brief Register the interfaces.
+     *
+     *  @param[in] bus - The bus to serve on.
+     *  @param[in] root - The inventory root path.
+     *  @param[in] interfaces - The interfaces to serve.
+     *  @param[in] find - Looks up objects.
+     *  @param[in] enumerate - Lists objects.
+     *  @param[in] write - Applies Set requests.  Without it, Set
+     *      updates the values and sends PropertiesChanged itself.
+     */
+    Server(sdbusplus::bus_t& bus, const char* root,
+           std::span<const InterfaceInfo* const> interfaces, Find&& find,
+           Enumerate&& enumerate, Write&& write = {});
+
+  private:
+    friend class Values;
+
+    /** @brief The context of an interface's fallback vtable. */
+    struct Fallback
+    {
+        Server* server;
+        std::size_t interface;
+    };
+
+    /** @brief sd-bus fallback vtable find callback. */
+    static int findObject(sd_bus* bus, const char* path, const char* interface,
+                          void* userdata, void** found, sd_bus_error* error);
+
+    /** @brief sd-bus node enumerator callback. */
+    static int enumerateObjects(sd_bus* bus, const char* prefix,
+                                void* userdata, char*** nodes,
+                                sd_bus_error* error);
+
+    Find _find;
+    Enumerate _enumerate;
+    Write _write;
+    std::vector<Fallback> _fallbacks;
+    std::vector<sdbusplus::slot_t> _slots;
+};
+
+} // namespace compact
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/slot.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+namespace detail
+{
+/** @brief Storage for the value of a finished Task. */
+template <typename T>
+struct TaskResult
+{
+    void return_value(T value)
+    {
+        _value.emplace(std::move(value));
+    }
+
+    T take()
+    {
+        return std::move(*_value);
+    }
+
+    std::optional<T> _value;
+};
+
+template <>
+struct TaskResult<void>
+{
+    void return_void() noexcept {}
+
+    void take() noexcept {}
+};
+} // namespace detail
+
+/** @class Task
+ *  @brief A lazily started coroutine producing a T.
+ *
+ *  The coroutine starts when the task is awaited, and the awaiting
+ *  coroutine is resumed when it finishes.  Exceptions are rethrown to
+ *  the awaiter.
+ *
+ *  @tparam T - The type of the produced value.
+ */
+template <typename T = void>
+class [[nodiscard]] Task
+{
+  public:
+    struct promise_type : detail::TaskResult<T>
+    {
+        Task get_return_object() noexcept
+        {
+            return Task(Handle::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct Resume
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(Handle h) noexcept
+                {
+                    return h.promise()._continuation;
+                }
+
+                void await_resume() noexcept {}
+            };
+            return Resume{};
+        }
+
+        void unhandled_exception() noexcept
+        {
+            _error = std::current_exception();
+        }
+
+        std::coroutine_handle<> _continuation = std::noop_coroutine();
+        std::exception_ptr _error;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = delete;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& other) noexcept :
+        _handle(std::exchange(other._handle, nullptr))
+    {}
+    Task& operator=(Task&&) = delete;
+    ~Task()
+    {
+        if (_handle)
+        {
+            _handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        _handle.promise()._continuation = h;
+        return _handle;
+    }
+
+    T await_resume()
+    {
+        auto& promise = _handle.promise();
+        if (promise._error)
+        {
+            std::rethrow_exception(promise._error);
+        }
+        return promise.take();
+    }
+
+  private:
+    explicit Task(Handle h) noexcept : _handle(h) {}
+
+    Handle _handle;
+};
+
+namespace detail
+{
+/** @brief A coroutine that starts right away and frees itself. */
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+} // namespace detail
+
+/** @brief Start a task without waiting for it.
+ *
+ *  The task runs until it first suspends before spawn returns, and is
+ *  freed when it finishes.  It must not throw.
+ *
+ *  @param[in] task - The task to run.
+ */
+inline detail::Detached spawn(Task<> task)
+{
+    co_await std::move(task);
+}
+
+/** @class AsyncCall
+ *  @brief Awaitable DBus method call.
+ *
+ *  Suspends the awaiting coroutine until the reply arrives, leaving the
+ *  event loop free in the meantime.
+ */
+class AsyncCall
+{
+  public:
+    /** @brief Constructor
+     *
+     *  @param[in] call - The method call message to send.
+     */
+    explicit AsyncCall(sdbusplus::message_t&& call) : _call(std::move(call))
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        _slot = _call.call_async([this, h](sdbusplus::message_t& reply) {
+            _reply = reply;
+            h.resume();
+        });
+    }
+
+    /** @brief The method reply.
+     *
+     *  @throws sdbusplus::exception::SdBusError if the call failed.
+     */
+    sdbusplus::message_t await_resume()
+    {
+        if (_reply.is_method_error())
+        {
+            throw sdbusplus::exception::SdBusError(_reply.get_errno(),
+                                                   "sd_bus_call_async");
+        }
+        return std::move(_reply);
+    }
+
+  private:
+    sdbusplus::message_t _call;
+    sdbusplus::message_t _reply;
+    std::optional<sdbusplus::slot_t> _slot;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
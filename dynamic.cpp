@@ -0,0 +1,177 @@
+#include "dynamic.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+namespace compact
+{
+namespace
+{
+/** @brief The default value of a property, which also sets its type.
+ *
+ *  @param[in] signature - The DBus signature of the property.
+ *  @param[in] value - The described default, or null.
+ *
+ *  @returns The value, or nullopt if the compact store can't hold the
+ *      type, in which case the property is served as a Fixed.
+ */
+std::optional<InterfaceVariantType> initial(std::string_view signature,
+                                            const nlohmann::json& value)
+{
+    auto init = [&](auto v) -> InterfaceVariantType {
+        if (!value.is_null())
+        {
+            value.get_to(v);
+        }
+        return v;
+    };
+
+    if (signature == "b")
+        return init(bool{});
+    if (signature == "q")
+        return init(uint16_t{});
+    if (signature == "x")
+        return init(int64_t{});
+    if (signature == "t")
+        return init(size_t{});
+    if (signature == "s")
+        return init(std::string{});
+    if (signature == "ay")
+        return init(std::vector<uint8_t>{});
+    if (signature == "as")
+        return init(std::vector<std::string>{});
+    return std::nullopt;
+}
+} // namespace
+
+Registry::Registry(const nlohmann::json& description)
+{
+    for (const auto& jsonIface : description.at("interfaces"))
+    {
+        auto d = std::make_unique<Description>();
+        d->name = jsonIface.at("name");
+
+        // Collect the strings first; the property and vtable entries
+        // point into them, so they must not move afterwards.
+        std::vector<InterfaceVariantType> inits;
+        std::vector<bool> writable;
+        std::vector<bool> constant;
+        for (const auto& jsonProp : jsonIface.value("properties",
+                                                    nlohmann::json::array()))
+        {
+            std::string name = jsonProp.at("name");
+            std::string signature = jsonProp.at("signature");
+            auto value = jsonProp.value("default", nlohmann::json());
+            auto init = initial(signature, value);
+            if (!init || jsonProp.value("fixed", false))
+            {
+                if (value.is_null())
+                {
+                    lg2::error("Ignoring property {PROPERTY} of {INTERFACE} "
+                               "with unsupported signature {SIGNATURE} and "
+                               "no default",
+                               "PROPERTY", name, "INTERFACE", d->name,
+                               "SIGNATURE", signature);
+                    continue;
+                }
+                d->fixedNames.push_back(std::move(name));
+                d->fixedSignatures.push_back(std::move(signature));
+                d->fixedValues.push_back(value.dump());
+                continue;
+            }
+
+            auto flags = jsonProp.value("flags", std::vector<std::string>{});
+            auto hasFlag = [&flags](std::string_view flag) {
+                return std::ranges::find(flags, flag) != flags.end();
+            };
+
+            d->names.push_back(std::move(name));
+            d->signatures.push_back(std::move(signature));
+            d->values.push_back(
+                jsonProp.value("enumeration", std::vector<std::string>{}));
+            inits.push_back(std::move(*init));
+            writable.push_back(!hasFlag("const") && !hasFlag("readonly"));
+            constant.push_back(hasFlag("const"));
+        }
+
+        d->vtable.push_back(sdbusplus::vtable::start());
+        for (std::size_t i = 0; i < d->names.size(); ++i)
+        {
+            auto& enumeration = d->enumerations.emplace_back();
+            for (const auto& v : d->values[i])
+            {
+                enumeration.push_back(v.c_str());
+            }
+
+            auto flags = constant[i]
+                             ? sdbusplus::vtable::property_::const_
+                             : sdbusplus::vtable::property_::emits_change;
+            d->vtable.push_back(
+                writable[i]
+                    ? sdbusplus::vtable::property(
+                          d->names[i].c_str(), d->signatures[i].c_str(),
+                          Values::get, Values::set, flags)
+                    : sdbusplus::vtable::property(d->names[i].c_str(),
+                                                  d->signatures[i].c_str(),
+                                                  Values::get, flags));
+        }
+        for (std::size_t i = 0; i < d->fixedNames.size(); ++i)
+        {
+            d->fixed.push_back({d->fixedNames[i].c_str(),
+                                d->fixedSignatures[i].c_str(),
+                                d->fixedValues[i].c_str()});
+            d->vtable.push_back(sdbusplus::vtable::property(
+                d->fixedNames[i].c_str(), d->fixedSignatures[i].c_str(),
+                Values::getFixed, sdbusplus::vtable::property_::const_));
+        }
+        d->vtable.push_back(sdbusplus::vtable::end());
+
+        for (std::size_t i = 0; i < d->names.size(); ++i)
+        {
+            d->properties.push_back(
+                {d->names[i].c_str(), std::move(inits[i]), d->enumerations[i]});
+        }
+
+        d->info = {d->name.c_str(), d->properties, d->vtable.data(),
+                   Dynamic::values, d->fixed};
+        _descriptions.push_back(std::move(d));
+    }
+
+    // Interface IDs are positions in name order, as with pimgen.
+    auto name = [](const auto& d) -> std::string_view { return d->name; };
+    std::ranges::sort(_descriptions, std::less<>(), name);
+    auto dups = std::ranges::unique(_descriptions, std::equal_to<>(), name);
+    _descriptions.erase(dups.begin(), dups.end());
+
+    _interfaces.reserve(_descriptions.size());
+    for (const auto& d : _descriptions)
+    {
+        _interfaces.push_back(&d->info);
+    }
+}
+
+Registry Registry::load(const std::filesystem::path& file)
+{
+    std::ifstream stream{file};
+    if (!stream)
+    {
+        throw std::runtime_error("Unable to open " + file.string());
+    }
+    return Registry(nlohmann::json::parse(stream, nullptr, true));
+}
+
+} // namespace compact
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
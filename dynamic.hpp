@@ -0,0 +1,161 @@
+#pragma once
+
+#include "compact.hpp"
+#include "interface_ops.hpp"
+#include "types.hpp"
+
+#include <nlohmann/json.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+namespace compact
+{
+
+/** @class Dynamic
+ *  @brief The compact store type of an interface described at runtime.
+ *
+ *  A single type for every interface, unlike Binding and Marker, so the
+ *  interface ops are instantiated once rather than once per interface.
+ */
+class Dynamic : public Values
+{
+  public:
+    using PropertiesVariant = InterfaceVariantType;
+
+    /** @brief Construct an interface from the values received for it.
+     *
+     *  @param[in] info - The interface.
+     *  @param[in] values - The property values to set.
+     */
+    Dynamic(const InterfaceInfo& info, const Interface& values) : Values(info)
+    {
+        for (const auto& [name, value] : values)
+        {
+            setPropertyByName(name, value);
+        }
+    }
+
+    /** @brief Read all properties. */
+    Interface properties() const
+    {
+        Interface props;
+        props.reserve(info().properties.size());
+        for (const auto& p : info().properties)
+        {
+            props.emplace(p.name, getPropertyByName(p.name));
+        }
+        return props;
+    }
+
+    /** @brief Access the values held by an interface holder. */
+    static Values& values(InterfaceHolder& holder)
+    {
+        return holder.get<Dynamic>();
+    }
+
+    template <class Archive>
+    void save(Archive& a) const
+    {
+        Values::save(a);
+    }
+
+    template <class Archive>
+    void load(Archive& a)
+    {
+        Values::load(a);
+    }
+};
+
+/** @class Registry
+ *  @brief Interfaces of the compact store described at runtime.
+ *
+ *  pimgen writes the description of the interfaces PIM can create as a
+ *  JSON document, which is loaded at startup in place of the code pimgen
+ *  otherwise generates per interface:
+ *
+ *  {
+ *      "interfaces": [
+ *          {
+ *              "name": "xyz.openbmc_project.Inventory.Item",
+ *              "properties": [
+ *                  {"name": "Present", "signature": "b", "default": false},
+ *                  ...
+ *              ]
+ *          },
+ *          ...
+ *      ]
+ *  }
+ *
+ *  Properties may also have an "enumeration" of the DBus names of their
+ *  values, and "flags" from the interface YAML.  Properties marked
+ *  "fixed", and those of types the compact store can't hold, are served
+ *  read-only with their default; see Fixed for how it is written.
+ */
+class Registry
+{
+  public:
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+    Registry(Registry&&) = default;
+    Registry& operator=(Registry&&) = default;
+    ~Registry() = default;
+
+    /** @brief Build the interfaces from their description.
+     *
+     *  Properties of types the compact store can't hold are left out
+     *  only if they have no default.
+     *
+     *  @param[in] description - The description.
+     */
+    explicit Registry(const nlohmann::json& description);
+
+    /** @brief Build the interfaces described by a file.
+     *
+     *  @param[in] file - The description file.
+     */
+    static Registry load(const std::filesystem::path& file);
+
+    /** @brief The interfaces, sorted by name. */
+    std::span<const InterfaceInfo* const> interfaces() const noexcept
+    {
+        return _interfaces;
+    }
+
+  private:
+    /** @brief An interface, and the storage its InterfaceInfo refers to. */
+    struct Description
+    {
+        std::string name;
+        std::vector<std::string> names;
+        std::vector<std::string> signatures;
+        std::vector<std::vector<std::string>> values;
+        std::vector<std::vector<const char*>> enumerations;
+        std::vector<Property> properties;
+        std::vector<std::string> fixedNames;
+        std::vector<std::string> fixedSignatures;
+        std::vector<std::string> fixedValues;
+        std::vector<Fixed> fixed;
+        std::vector<sdbusplus::vtable_t> vtable;
+        InterfaceInfo info;
+    };
+
+    std::vector<std::unique_ptr<Description>> _descriptions;
+    std::vector<const InterfaceInfo*> _interfaces;
+};
+
+} // namespace compact
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
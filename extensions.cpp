@@ -0,0 +1,149 @@
+#include "config.h"
+
+#include "extensions.hpp"
+
+#include "manager.hpp"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+const sdbusplus::vtable_t Extensions::_vtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("ApplyDelta", "a{oa{sa{sv}}}a{oas}", "",
+                              Extensions::applyDelta),
+    sdbusplus::vtable::method("BeginTransaction", "", "",
+                              Extensions::beginTransaction),
+    sdbusplus::vtable::method("CommitTransaction", "", "",
+                              Extensions::commitTransaction),
+    sdbusplus::vtable::method("GetChangesSince", "tt",
+                              "ttba{oa{sa{sv}}}a{oas}",
+                              Extensions::getChangesSince),
+    sdbusplus::vtable::method("GetObjects", "sassu", "a{oa{sa{sv}}}s",
+                              Extensions::getObjects),
+    sdbusplus::vtable::method("GetStatistics", "", "a{st}",
+                              Extensions::getStatistics),
+    sdbusplus::vtable::method("Query", "sa{sv}su", "aos", Extensions::query),
+    sdbusplus::vtable::end(),
+};
+
+Extensions::Extensions(sdbusplus::bus_t& bus, const char* root,
+                       Manager& manager, std::string peer) :
+    _manager(manager), _peer(std::move(peer)),
+    _interface(bus, root, EXTENSIONS_IFACE, _vtable, this)
+{}
+
+std::string Extensions::client(sdbusplus::message_t& m) const
+{
+    // Messages on a peer connection have no sender.
+    const char* sender = m.get_sender();
+    return sender ? sender : _peer;
+}
+
+int Extensions::applyDelta(sd_bus_message* msg, void* context,
+                           sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        std::map<sdbusplus::object_path, Object> update;
+        std::map<sdbusplus::object_path, std::vector<std::string>> remove;
+        m.read(update, remove);
+        self._manager.applyDelta(std::move(update), remove);
+        m.new_method_return().method_return();
+    });
+}
+
+int Extensions::beginTransaction(sd_bus_message* msg, void* context,
+                                 sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        self._manager.beginTransaction(self.client(m));
+        m.new_method_return().method_return();
+    });
+}
+
+int Extensions::commitTransaction(sd_bus_message* msg, void* context,
+                                  sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        self._manager.commitTransaction(self.client(m));
+        m.new_method_return().method_return();
+    });
+}
+
+int Extensions::getChangesSince(sd_bus_message* msg, void* context,
+                                sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        uint64_t stream = 0;
+        uint64_t generation = 0;
+        m.read(stream, generation);
+        auto changes = self._manager.changesSince(stream, generation);
+        auto reply = m.new_method_return();
+        reply.append(changes.stream, changes.generation, changes.resync,
+                     changes.update, changes.remove);
+        reply.method_return();
+    });
+}
+
+int Extensions::getObjects(sd_bus_message* msg, void* context,
+                           sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        std::string prefix;
+        std::vector<std::string> interfaces;
+        std::string cursor;
+        uint32_t count = 0;
+        m.read(prefix, interfaces, cursor, count);
+        auto [objects, next] =
+            self._manager.getObjects(prefix, interfaces, cursor, count);
+        auto reply = m.new_method_return();
+        reply.append(objects, next);
+        reply.method_return();
+    });
+}
+
+int Extensions::getStatistics(sd_bus_message* msg, void* context,
+                              sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        auto reply = m.new_method_return();
+        reply.append(self._manager.statistics());
+        reply.method_return();
+    });
+}
+
+int Extensions::query(sd_bus_message* msg, void* context,
+                      sd_bus_error* error)
+{
+    auto& self = *static_cast<Extensions*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        std::string interface;
+        std::map<std::string, InterfaceVariantType> properties;
+        std::string cursor;
+        uint32_t count = 0;
+        m.read(interface, properties, cursor, count);
+        auto [paths, next] =
+            self._manager.query(interface, properties, cursor, count);
+        auto reply = m.new_method_return();
+        reply.append(paths, next);
+        reply.method_return();
+    });
+}
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/server/interface.hpp>
+#include <sdbusplus/vtable.hpp>
+#include <systemd/sd-bus.h>
+
+#include <exception>
+#include <string>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+/** @brief Run a method implementation, reporting failures as DBus errors.
+ *
+ *  @param[in] msg - The method call message.
+ *  @param[out] error - The DBus error to set on failure.
+ *  @param[in] f - The implementation, which reads msg and replies.
+ */
+template <typename F>
+int handleMethod(sd_bus_message* msg, sd_bus_error* error, F&& f)
+{
+    try
+    {
+        sdbusplus::message_t m{msg};
+        f(m);
+        return 1;
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        return sd_bus_error_set(error, e.name(), e.description());
+    }
+    catch (const std::exception& e)
+    {
+        return sd_bus_error_set(error, SD_BUS_ERROR_FAILED, e.what());
+    }
+}
+
+/** @class Extensions
+ *  @brief Inventory manager DBus methods beyond the Manager interface.
+ *
+ *  The methods are hosted on the EXTENSIONS_IFACE interface at the
+ *  inventory root, next to xyz.openbmc_project.Inventory.Manager.
+ */
+class Extensions
+{
+  public:
+    Extensions() = delete;
+    Extensions(const Extensions&) = delete;
+    Extensions& operator=(const Extensions&) = delete;
+    Extensions(Extensions&&) = delete;
+    Extensions& operator=(Extensions&&) = delete;
+    ~Extensions() = default;
+
+    /** @brief Construct the extension methods.
+     *
+     *  @param[in] bus - An sdbusplus bus connection.
+     *  @param[in] root - The inventory root path.
+     *  @param[in] manager - The manager implementing the methods.
+     *  @param[in] peer - On a peer connection, the name its client is
+     *      known by.  Bus clients are known by their unique names.
+     */
+    Extensions(sdbusplus::bus_t& bus, const char* root, Manager& manager,
+               std::string peer = {});
+
+  private:
+    /** @brief The client that sent a method call. */
+    std::string client(sdbusplus::message_t& m) const;
+
+    /** @brief ApplyDelta method callback.
+     *
+     *  Takes the objects to add or update, a{oa{sa{sv}}} as with Notify,
+     *  and the interfaces to remove from each object, a{oas}.
+     */
+    static int applyDelta(sd_bus_message* msg, void* context,
+                          sd_bus_error* error);
+
+    /** @brief BeginTransaction method callback. */
+    static int beginTransaction(sd_bus_message* msg, void* context,
+                                sd_bus_error* error);
+
+    /** @brief CommitTransaction method callback. */
+    static int commitTransaction(sd_bus_message* msg, void* context,
+                                 sd_bus_error* error);
+
+    /** @brief GetChangesSince method callback.
+     *
+     *  Takes a stream ID and generation, tt.  Returns the current stream
+     *  ID and generation, whether a resync is needed, and the changes as
+     *  with ApplyDelta, ttba{oa{sa{sv}}}a{oas}.
+     */
+    static int getChangesSince(sd_bus_message* msg, void* context,
+                               sd_bus_error* error);
+
+    /** @brief GetObjects method callback.
+     *
+     *  Takes a path prefix, the interfaces to return, a cursor and a page
+     *  size, sassu.  Returns a page of objects and the next cursor,
+     *  a{oa{sa{sv}}} s.
+     */
+    static int getObjects(sd_bus_message* msg, void* context,
+                          sd_bus_error* error);
+
+    /** @brief GetStatistics method callback.
+     *
+     *  Returns the manager counters, a{st}.
+     */
+    static int getStatistics(sd_bus_message* msg, void* context,
+                             sd_bus_error* error);
+
+    /** @brief Query method callback.
+     *
+     *  Takes an interface, the property values to match, a cursor and a
+     *  page size, sa{sv}su.  Returns a page of matching object paths and
+     *  the next cursor, aos.
+     */
+    static int query(sd_bus_message* msg, void* context,
+                     sd_bus_error* error);
+
+    /** @brief The method table. */
+    static const sdbusplus::vtable_t _vtable[];
+
+    /** @brief The manager implementing the methods. */
+    Manager& _manager;
+
+    /** @brief The client's name on a peer connection. */
+    std::string _peer;
+
+    /** @brief The sdbusplus registration of _vtable. */
+    sdbusplus::server::interface_t _interface;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -30,14 +30,14 @@ namespace manager
 {
 namespace functor
 {
-bool PropertyConditionBase::operator()(
+Task<bool> PropertyConditionBase::operator()(
     sdbusplus::bus_t& bus, sdbusplus::message_t&, Manager& mgr) const
 {
     std::string path(_path);
-    return (*this)(path, bus, mgr);
+    co_return co_await (*this)(path, bus, mgr);
 }
 
-bool PropertyConditionBase::operator()(
+Task<bool> PropertyConditionBase::operator()(
     const std::string& path, sdbusplus::bus_t& bus, Manager& mgr) const
 {
     std::string host;
@@ -58,19 +58,20 @@ bool PropertyConditionBase::operator()(
         std::map<std::string, std::vector<std::string>> mapperResponse;
         try
         {
-            auto mapperResponseMsg = bus.call(mapperCall);
+            auto mapperResponseMsg =
+                co_await AsyncCall(std::move(mapperCall));
             mapperResponseMsg.read(mapperResponse);
         }
         catch (const std::exception& e)
         {
             lg2::error("Failed to execute GetObject method: {ERROR}", "ERROR",
                        e);
-            return false;
+            co_return false;
         }
 
         if (mapperResponse.empty())
         {
-            return false;
+            co_return false;
         }
 
         host = mapperResponse.begin()->first;
@@ -83,13 +84,13 @@ bool PropertyConditionBase::operator()(
     {
         try
         {
-            return eval(mgr);
+            co_return eval(mgr);
         }
         catch (const std::exception& e)
         {
             // Unable to find property on inventory manager,
             // default condition to false.
-            return false;
+            co_return false;
         }
     }
 
@@ -100,13 +101,13 @@ bool PropertyConditionBase::operator()(
 
     try
     {
-        auto hostResponseMsg = bus.call(hostCall);
-        return eval(hostResponseMsg);
+        auto hostResponseMsg = co_await AsyncCall(std::move(hostCall));
+        co_return eval(hostResponseMsg);
     }
     catch (const std::exception& e)
     {
         lg2::error("Failed to execute Get method: {ERROR}", "ERROR", e);
-        return false;
+        co_return false;
     }
 }
 
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "config.h"
+
 #include "types.hpp"
 #include "utils.hpp"
 
 #include <sdbusplus/bus.hpp>
 
+#include <cstring>
 #include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace phosphor
@@ -78,17 +82,21 @@ auto make_get_property(U&& method)
     return GetProperty<T>(std::forward<U>(method));
 }
 
+/** @brief Await each callback in turn until one fails.
+ *
+ *  @returns - True if every callback passed.
+ */
 template <typename T, typename... Args>
-auto callArrayWithStatus(T&& container, Args&&... args)
+Task<bool> callArrayWithStatus(const T& container, Args&... args)
 {
-    for (auto f : container)
+    for (const auto& f : container)
     {
-        if (!f(std::forward<Args>(args)...))
+        if (!co_await f(args...))
         {
-            return false;
+            co_return false;
         }
     }
-    return true;
+    co_return true;
 }
 
 namespace functor
@@ -98,10 +106,10 @@ namespace functor
 inline auto destroyObjects(std::vector<const char*>&& paths,
                            std::vector<PathCondition>&& conditions)
 {
-    return [=](auto& b, auto& m) {
+    return [=](auto& b, auto& m) -> Task<> {
         for (const auto& p : paths)
         {
-            if (callArrayWithStatus(conditions, p, b, m))
+            if (co_await callArrayWithStatus(conditions, p, b, m))
             {
                 m.destroyObjects({p});
             }
@@ -109,18 +117,38 @@ inline auto destroyObjects(std::vector<const char*>&& paths,
     };
 }
 
+/** @brief Destroy object subtrees action.  */
+inline auto destroySubtrees(std::vector<const char*>&& paths,
+                            std::vector<PathCondition>&& conditions)
+{
+    return [=](auto& b, auto& m) -> Task<> {
+        for (const auto& p : paths)
+        {
+            if (co_await callArrayWithStatus(conditions, p, b, m))
+            {
+                m.destroySubtree(p);
+            }
+        }
+    };
+}
+
 /** @brief Create objects action.  */
 inline auto createObjects(std::map<sdbusplus::object_path, Object>&& objs)
 {
-    return [=](auto&, auto& m) { m.createObjects(objs); };
+    return [=](auto&, auto& m) -> Task<> {
+        m.createObjects(objs);
+        co_return;
+    };
 }
 
 /** @brief Set a property action.
  *
  *  Invoke the requested method with a reference to the requested
- *  sdbusplus server binding interface as a parameter.
+ *  sdbusplus server binding interface as a parameter.  With the
+ *  compact store, the property is set by name instead.
  *
  *  @tparam T - The sdbusplus server binding interface type.
+ *  @tparam C - The type the compact store keeps the property as.
  *  @tparam U - The type of the sdbusplus server binding member
  *      function that sets the property.
  *  @tparam V - The property value type.
@@ -128,37 +156,67 @@ inline auto createObjects(std::map<sdbusplus::object_path, Object>&& objs)
  *  @param[in] paths - The DBus paths on which the property should
  *      be set.
  *  @param[in] iface - The DBus interface hosting the property.
+ *  @param[in] property - The property name.
  *  @param[in] member - Pointer to sdbusplus server binding member.
  *  @param[in] value - The value the property should be set to.
  *
  *  @returns - A function object that sets the requested property
  *      to the requested value.
  */
-template <typename T, typename U, typename V>
+template <typename T, typename C, typename U, typename V>
 auto setProperty(std::vector<const char*>&& paths,
                  std::vector<PathCondition>&& conditions, const char* iface,
-                 U&& member, V&& value)
+                 [[maybe_unused]] const char* property,
+                 [[maybe_unused]] U&& member, V&& value)
 {
+#ifdef COMPACT_STORE
+    return [paths, conditions = conditions, iface, property,
+            value = std::forward<V>(value)](auto& b, auto& m) -> Task<> {
+        using W = std::decay_t<decltype(value)>;
+        for (auto p : paths)
+        {
+            if (co_await callArrayWithStatus(conditions, p, b, m))
+            {
+                // The compact store keeps enumerations as strings.
+                if constexpr (std::is_enum_v<W>)
+                {
+                    m.setPropertyValue(
+                        p, iface, property,
+                        sdbusplus::message::convert_to_string(value));
+                }
+                else
+                {
+                    m.setPropertyValue(
+                        p, iface, property,
+                        InterfaceVariantType(std::in_place_type<C>,
+                                             static_cast<C>(value)));
+                }
+            }
+        }
+    };
+#else
     // The manager is the only parameter passed to actions.
     // Bind the path, interface, interface member function pointer,
     // and value to a lambda.  When it is called, forward the
     // path, interface and value on to the manager member function.
     return [paths, conditions = conditions, iface, member,
-            value = std::forward<V>(value)](auto& b, auto& m) {
+            value = std::forward<V>(value)](auto& b, auto& m) -> Task<> {
         for (auto p : paths)
         {
-            if (callArrayWithStatus(conditions, p, b, m))
+            if (co_await callArrayWithStatus(conditions, p, b, m))
             {
                 m.template invokeMethod<T>(p, iface, member, value);
             }
         }
     };
+#endif
 }
 
 /** @brief Get a property.
  *
  *  Invoke the requested method with a reference to the requested
- *  sdbusplus server binding interface as a parameter.
+ *  sdbusplus server binding interface as a parameter.  With the
+ *  compact store, the property is read by name instead.
  *
  *  @tparam T - The sdbusplus server binding interface type.
  *  @tparam U - The type of the sdbusplus server binding member
@@ -172,12 +230,19 @@ auto setProperty(std::vector<const char*>&& paths,
  *  @returns - A function object that gets the requested property.
  */
 template <typename T, typename U>
-inline auto getProperty(const char* path, const char* iface, U&& member,
-                        const char* prop)
+inline auto getProperty(const char* path, const char* iface,
+                        [[maybe_unused]] U&& member, const char* prop)
 {
+#ifdef COMPACT_STORE
+    return [path, iface, prop](auto& mgr) {
+        return convertVariant<typename T::PropertiesVariant>(
+            mgr.getPropertyValue(path, iface, prop));
+    };
+#else
     return [path, iface, member, prop](auto& mgr) {
         return mgr.template invokeMethod<T>(path, iface, member, prop);
     };
+#endif
 }
 
 /** @struct PropertyChangedCondition
@@ -207,8 +272,8 @@ struct PropertyChangedCondition
      * Extract the property from the PropertiesChanged
      * message and run the condition test.
      */
-    bool operator()(sdbusplus::bus_t&, sdbusplus::message_t& msg,
-                    Manager&) const
+    Task<bool> operator()(sdbusplus::bus_t&, sdbusplus::message_t& msg,
+                          Manager&) const
     {
         std::map<std::string, std::variant<T>> properties;
         const char* iface = nullptr;
@@ -216,17 +281,17 @@ struct PropertyChangedCondition
         msg.read(iface);
         if (!iface || strcmp(iface, _iface))
         {
-            return false;
+            co_return false;
         }
 
         msg.read(properties);
         auto it = properties.find(_property);
         if (it == properties.cend())
         {
-            return false;
+            co_return false;
         }
 
-        return _condition(std::forward<T>(std::get<T>(it->second)));
+        co_return _condition(std::forward<T>(std::get<T>(it->second)));
     }
 
   private:
@@ -280,13 +345,16 @@ struct PropertyConditionBase
      *
      * Make a DBus call and test the value of any property.
      */
-    bool operator()(sdbusplus::bus_t&, sdbusplus::message_t&, Manager&) const;
+    Task<bool> operator()(sdbusplus::bus_t&, sdbusplus::message_t&,
+                          Manager&) const;
 
     /** @brief Test a property value.
      *
-     * Make a DBus call and test the value of any property.
+     * Make a DBus call and test the value of any property.  The calls
+     * are awaited, so other work continues while they are in flight.
      */
-    bool operator()(const std::string&, sdbusplus::bus_t&, Manager&) const;
+    Task<bool> operator()(const std::string&, sdbusplus::bus_t&,
+                          Manager&) const;
 
   private:
     std::string _path;
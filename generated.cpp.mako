@@ -10,6 +10,9 @@
 % endfor
 #include "gen_serialization.hpp"
 
+#include <array>
+#include <limits>
+
 namespace phosphor
 {
 namespace inventory
@@ -19,33 +22,113 @@ namespace manager
 
 using namespace std::literals::string_literals;
 
+// With dynamic interfaces, the makers and compact store interfaces are
+// built at startup from interfaces.json instead.
+#ifndef DYNAMIC_INTERFACES
+namespace
+{
+#ifdef COMPACT_STORE
+% for i in interfaces:
+<%
+    props = interface_composite.compact(str(i))
+    fixed = interface_composite.fixed(str(i))
+    kind = "Binding" if interface_composite.names(str(i)) else "Marker"
+%>\
+// ID ${loop.index}
+% for p in props:
+% if p.enumeration:
+<% values = ', '.join('"' + e + '"' for e in p.enumeration) %>\
+constexpr std::array<const char*, ${len(p.enumeration)}>
+    compactEnum${loop.parent.index}_${loop.index}{${values}};
+% endif
+% endfor
+const std::array<compact::Property, ${len(props)}>
+    compactProperties${loop.index}{{
+% for p in props:
+<% enum = "compactEnum%d_%d" % (loop.parent.index, loop.index) if p.enumeration else "{}" %>\
+    {"${p.name}", ${p.init}, ${enum}},
+% endfor
+}};
+% if fixed:
+const std::array<compact::Fixed, ${len(fixed)}> compactFixed${loop.index}{{
+% for p in fixed:
+    {"${p.name}", "${p.fixed[0]}", R"json(${p.fixed_value()})json"},
+% endfor
+}};
+% endif
+const sdbusplus::vtable_t compactVtable${loop.index}[] = {
+    sdbusplus::vtable::start(),
+% for p in props:
+% if p.writable():
+    sdbusplus::vtable::property("${p.name}", "${p.signature}",
+                                compact::Values::get, compact::Values::set,
+                                ${p.vtable_flags()}),
+% else:
+    sdbusplus::vtable::property("${p.name}", "${p.signature}",
+                                compact::Values::get,
+                                ${p.vtable_flags()}),
+% endif
+% endfor
+% for p in fixed:
+    sdbusplus::vtable::property("${p.name}", "${p.fixed[0]}",
+                                compact::Values::getFixed,
+                                sdbusplus::vtable::property_::const_),
+% endfor
+    sdbusplus::vtable::end(),
+};
+const compact::InterfaceInfo compactInfo${loop.index}{
+    "${str(i)}", compactProperties${loop.index}, compactVtable${loop.index},
+    +[](InterfaceHolder& holder) -> compact::Values& {
+        return holder.get<compact::${kind}<compactInfo${loop.index}>>();
+    },
+    ${"compactFixed%d" % loop.index if fixed else "{}"}};
+using Binding${loop.index} = compact::${kind}<compactInfo${loop.index}>;
+
+% endfor
+#else
+% for i in interfaces:
+using Binding${loop.index} = ServerObject<${i.namespace()}>;
+% endfor
+#endif
+} // namespace
+
 const Manager::Makers Manager::_makers{
 % for i in interfaces:
+    // ID ${loop.index}
     {
         "${str(i)}",
         std::make_tuple(
-            MakeInterface<
-                ServerObject<
-                    ${i.namespace()}>>::op,
-            AssignInterface<
-                ServerObject<
-                    ${i.namespace()}>>::op,
-            SerializeInterface<
-                ServerObject<
-                    ${i.namespace()}>, SerialOps>::op,
-            DeserializeInterface<
-                ServerObject<
-                    ${i.namespace()}>, SerialOps>::op
+            MakeInterface<Binding${loop.index}>::op,
+            AssignInterface<Binding${loop.index}>::op,
+            SerializeInterface<Binding${loop.index}, SerialOps>::op,
+            DeserializeInterface<Binding${loop.index}, SerialOps>::op,
+<% names = ', '.join('"' + p.CamelCase + '"' for p in interface_composite.names(str(i))) %>\
+<% compact_names = ', '.join('"' + p.name + '"' for p in interface_composite.compact(str(i))) %>\
+            +[](InterfaceHolder& holder) {
+                return GetProperties<Binding${loop.index}>::op(
+#ifdef COMPACT_STORE
+                    holder, {${compact_names}});
+#else
+                    holder, {${names}});
+#endif
+            }
 #ifdef CREATE_ASSOCIATIONS
-            , GetPropertyValue<
-                ServerObject<
-                    ${i.namespace()}>>::op
+            , GetPropertyValue<Binding${loop.index}>::op
 #endif
         )
     },
 % endfor
 };
 
+#ifdef COMPACT_STORE
+const Manager::CompactInfo Manager::_compactInfo{
+% for i in interfaces:
+    &compactInfo${loop.index},
+% endfor
+};
+#endif
+#endif
+
 const Manager::Events Manager::_events{
 % for e in events:
     {
@@ -57,6 +140,13 @@ const Manager::Events Manager::_events{
 %endfor
 };
 
+const Manager::IndexConfig Manager::_indexConfig{
+% for i in indexes:
+<% names = ', '.join('"' + p + '"' for p in i.get('properties', [])) %>\
+    {"${i['interface']}", {${names}}},
+% endfor
+};
+
 } // namespace manager
 } // namespace inventory
 } // namespace phosphor
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+/** @class InterfaceIndex
+ *  @brief The objects implementing an interface, and the objects with
+ *      each value of selected properties.
+ *
+ *  The index is kept up to date by the caller as interfaces are added,
+ *  changed and removed, one property at a time.
+ */
+class InterfaceIndex
+{
+  public:
+    /** @brief Object paths, in order. */
+    using Paths = std::set<std::string, std::less<>>;
+
+    InterfaceIndex() = delete;
+    InterfaceIndex(const InterfaceIndex&) = delete;
+    InterfaceIndex& operator=(const InterfaceIndex&) = delete;
+    InterfaceIndex(InterfaceIndex&&) = default;
+    InterfaceIndex& operator=(InterfaceIndex&&) = default;
+    ~InterfaceIndex() = default;
+
+    /** @brief Construct an index.
+     *
+     *  @param[in] properties - The names of the properties to index by
+     *      value.
+     */
+    explicit InterfaceIndex(const std::vector<std::string>& properties)
+    {
+        for (const auto& name : properties)
+        {
+            _properties.push_back({name, {}, {}});
+        }
+    }
+
+    /** @brief The number of properties indexed by value. */
+    std::size_t properties() const noexcept
+    {
+        return _properties.size();
+    }
+
+    /** @brief The name of a property indexed by value. */
+    const std::string& property(std::size_t property) const
+    {
+        return _properties[property].name;
+    }
+
+    /** @brief The objects implementing the interface. */
+    const Paths& paths() const noexcept
+    {
+        return _paths;
+    }
+
+    /** @brief The objects with a property value.
+     *
+     *  @param[in] property - The property name.
+     *  @param[in] value - The value.
+     *
+     *  @returns The objects, or nullptr if the property is not indexed.
+     */
+    const Paths* find(std::string_view property,
+                      const InterfaceVariantType& value) const
+    {
+        static const Paths none;
+        for (const auto& p : _properties)
+        {
+            if (p.name == property)
+            {
+                auto it = p.paths.find(value);
+                return it == p.paths.end() ? &none : &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    /** @brief Add an object that implements the interface.
+     *
+     *  @param[in] path - The object path.
+     */
+    void add(std::string_view path)
+    {
+        if (_paths.find(path) == _paths.end())
+        {
+            _paths.emplace(path);
+        }
+    }
+
+    /** @brief Record an object's property value.
+     *
+     *  @param[in] property - The property, by position in properties().
+     *  @param[in] path - The object path.
+     *  @param[in] value - The new value.
+     */
+    void set(std::size_t property, std::string_view path,
+             const InterfaceVariantType& value)
+    {
+        auto& p = _properties[property];
+        auto it = p.values.find(path);
+        if (it == p.values.end())
+        {
+            it = p.values.emplace(path, value).first;
+        }
+        else if (it->second == value)
+        {
+            return;
+        }
+        else
+        {
+            erase(p, it);
+            it = p.values.emplace(path, value).first;
+        }
+        p.paths[value].emplace(it->first);
+    }
+
+    /** @brief Remove an object that no longer implements the interface.
+     *
+     *  @param[in] path - The object path.
+     */
+    void remove(std::string_view path)
+    {
+        if (auto it = _paths.find(path); it != _paths.end())
+        {
+            _paths.erase(it);
+        }
+        for (auto& p : _properties)
+        {
+            if (auto it = p.values.find(path); it != p.values.end())
+            {
+                erase(p, it);
+            }
+        }
+    }
+
+  private:
+    struct Property
+    {
+        /** @brief The property name. */
+        std::string name;
+
+        /** @brief Objects, by property value. */
+        std::map<InterfaceVariantType, Paths> paths;
+
+        /** @brief Property values, by object. */
+        std::map<std::string, InterfaceVariantType, std::less<>> values;
+    };
+
+    /** @brief Drop an object's value from a property index. */
+    static void erase(Property& p, decltype(Property::values)::iterator it)
+    {
+        auto paths = p.paths.find(it->second);
+        paths->second.erase(it->first);
+        if (paths->second.empty())
+        {
+            p.paths.erase(paths);
+        }
+        p.values.erase(it);
+    }
+
+    Paths _paths;
+    std::vector<Property> _properties;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
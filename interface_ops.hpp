@@ -3,12 +3,13 @@
 #include "types.hpp"
 #include "utils.hpp"
 
-#include <any>
+#include <initializer_list>
 #include <map>
-#include <memory>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace phosphor
 {
@@ -36,41 +37,142 @@ struct HasProperties
     static constexpr auto value = sizeof(test<T>(0)) == sizeof(yes);
 };
 
+/** @class InterfaceHolder
+ *  @brief Owner of a single sdbusplus server binding.
+ *
+ *  The binding type is recorded as the address of a per-type tag, so
+ *  checking the type on access is a pointer comparison rather than an
+ *  RTTI lookup.  The binding is the only allocation.
+ */
+class InterfaceHolder
+{
+  public:
+    InterfaceHolder() = default;
+    InterfaceHolder(const InterfaceHolder&) = delete;
+    InterfaceHolder& operator=(const InterfaceHolder&) = delete;
+    InterfaceHolder(InterfaceHolder&& other) noexcept :
+        _binding(std::exchange(other._binding, nullptr)), _tag(other._tag),
+        _destroy(other._destroy)
+    {}
+    InterfaceHolder& operator=(InterfaceHolder&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            _binding = std::exchange(other._binding, nullptr);
+            _tag = other._tag;
+            _destroy = other._destroy;
+        }
+        return *this;
+    }
+    ~InterfaceHolder()
+    {
+        reset();
+    }
+
+    /** @brief Construct a binding and take ownership of it.
+     *
+     *  @tparam T - The sdbusplus server binding type.
+     *  @tparam Args - Binding constructor argument types.
+     *
+     *  @param[in] args - Arguments to forward to the binding constructor.
+     */
+    template <typename T, typename... Args>
+    static InterfaceHolder make(Args&&... args)
+    {
+        InterfaceHolder holder;
+        holder._binding = new T(std::forward<Args>(args)...);
+        holder._tag = &tag<T>;
+        holder._destroy = [](void* binding) {
+            delete static_cast<T*>(binding);
+        };
+        return holder;
+    }
+
+    /** @brief Test the type of the held binding. */
+    template <typename T>
+    bool holds() const noexcept
+    {
+        return _binding && _tag == &tag<T>;
+    }
+
+    /** @brief Access the held binding.
+     *
+     *  @tparam T - The sdbusplus server binding type.
+     *
+     *  @returns A reference to the binding.
+     *  @throws std::runtime_error if the binding is not a T.
+     */
+    template <typename T>
+    T& get()
+    {
+        if (!holds<T>())
+        {
+            throw std::runtime_error("interface holder type mismatch");
+        }
+        return *static_cast<T*>(_binding);
+    }
+
+    template <typename T>
+    const T& get() const
+    {
+        return const_cast<InterfaceHolder*>(this)->get<T>();
+    }
+
+  private:
+    /** @brief The per-type tag the binding type is identified by. */
+    template <typename T>
+    static constexpr char tag{};
+
+    void reset() noexcept
+    {
+        if (_binding)
+        {
+            _destroy(_binding);
+            _binding = nullptr;
+        }
+    }
+
+    void* _binding = nullptr;
+    const char* _tag = nullptr;
+    void (*_destroy)(void*) = nullptr;
+};
+
 template <typename T, typename Enable = void>
 struct MakeInterface
 {
-    static std::any op(sdbusplus::bus_t& bus, const char* path,
-                       const Interface&, bool)
+    static InterfaceHolder op(sdbusplus::bus_t& bus, const char* path,
+                              Interface&&, bool)
     {
-        return std::any(std::make_shared<T>(bus, path));
+        return InterfaceHolder::make<T>(bus, path);
     }
 };
 
 template <typename T>
 struct MakeInterface<T, std::enable_if_t<HasProperties<T>::value>>
 {
-    static std::any op(sdbusplus::bus_t& bus, const char* path,
-                       const Interface& props, bool deferSignal)
+    static InterfaceHolder op(sdbusplus::bus_t& bus, const char* path,
+                              Interface&& props, bool deferSignal)
     {
         using InterfaceVariant =
             std::map<std::string, typename T::PropertiesVariant>;
 
         InterfaceVariant v;
-        for (const auto& p : props)
+        for (auto& p : props)
         {
-            v.emplace(p.first,
-                      convertVariant<typename T::PropertiesVariant>(p.second));
+            v.emplace(p.first, convertVariant<typename T::PropertiesVariant>(
+                                   std::move(p.second)));
         }
 
-        return std::any(std::make_shared<T>(bus, path, v, deferSignal));
+        return InterfaceHolder::make<T>(bus, path, v, deferSignal);
     }
 };
 
 template <typename T, typename Enable = void>
 struct GetPropertyValue
 {
-    static InterfaceVariantType op(const std::string /* propertyName */,
-                                   std::any& /* holder */)
+    static InterfaceVariantType op(const std::string& /* propertyName */,
+                                   InterfaceHolder& /* holder */)
     {
         return InterfaceVariantType{};
     }
@@ -79,34 +181,91 @@ struct GetPropertyValue
 template <typename T>
 struct GetPropertyValue<T, std::enable_if_t<HasProperties<T>::value>>
 {
-    static InterfaceVariantType op(const std::string propertyName,
-                                   std::any& holder)
+    static InterfaceVariantType op(const std::string& propertyName,
+                                   InterfaceHolder& holder)
     {
-        auto& iface = *std::any_cast<std::shared_ptr<T>&>(holder);
+        auto& iface = holder.get<T>();
         auto property = iface.getPropertyByName(propertyName);
         return convertVariant<InterfaceVariantType>(property);
     }
 };
 
+template <typename T, typename Enable = void>
+struct GetProperties
+{
+    static Interface op(InterfaceHolder&, std::initializer_list<const char*>)
+    {
+        return {};
+    }
+};
+
+template <typename T>
+struct GetProperties<T, std::enable_if_t<HasProperties<T>::value>>
+{
+    /** @brief Read property values from a binding.
+     *
+     *  Properties of types Notify cannot carry are left out.
+     *
+     *  @param[in] holder - The binding.
+     *  @param[in] names - The names of the binding's properties.
+     */
+    static Interface op(InterfaceHolder& holder,
+                        std::initializer_list<const char*> names)
+    {
+        auto& iface = holder.get<T>();
+        Interface props;
+        props.reserve(names.size());
+        for (auto name : names)
+        {
+            try
+            {
+                props.emplace(name, convertVariant<InterfaceVariantType>(
+                                        iface.getPropertyByName(name)));
+            }
+            catch (const std::runtime_error&)
+            {}
+        }
+        return props;
+    }
+};
+
 template <typename T, typename Enable = void>
 struct AssignInterface
 {
-    static void op(const Interface&, std::any&, bool) {}
+    static std::vector<std::string> op(Interface&&, InterfaceHolder&, bool)
+    {
+        return {};
+    }
 };
 
 template <typename T>
 struct AssignInterface<T, std::enable_if_t<HasProperties<T>::value>>
 {
-    static void op(const Interface& props, std::any& holder, bool deferSignal)
+    /** @brief Assign new property values.
+     *
+     *  Values equal to the current ones are not assigned.
+     *
+     *  @returns The names of the properties that changed, moved out of
+     *      props.
+     */
+    static std::vector<std::string> op(Interface&& props,
+                                       InterfaceHolder& holder,
+                                       bool deferSignal)
     {
-        auto& iface = *std::any_cast<std::shared_ptr<T>&>(holder);
-        for (const auto& p : props)
+        auto& iface = holder.get<T>();
+        std::vector<std::string> changed;
+        for (auto& p : props)
         {
-            iface.setPropertyByName(
-                p.first,
-                convertVariant<typename T::PropertiesVariant>(p.second),
-                deferSignal);
+            auto value = convertVariant<typename T::PropertiesVariant>(
+                std::move(p.second));
+            if (iface.getPropertyByName(p.first) == value)
+            {
+                continue;
+            }
+            iface.setPropertyByName(p.first, std::move(value), deferSignal);
+            changed.push_back(std::move(p.first));
         }
+        return changed;
     }
 };
 
@@ -114,7 +273,7 @@ template <typename T, typename Ops, typename Enable = void>
 struct SerializeInterface
 {
     static void op(const std::string& path, const std::string& iface,
-                   const std::any&)
+                   const InterfaceHolder&)
     {
         Ops::serialize(path, iface);
     }
@@ -124,9 +283,9 @@ template <typename T, typename Ops>
 struct SerializeInterface<T, Ops, std::enable_if_t<HasProperties<T>::value>>
 {
     static void op(const std::string& path, const std::string& iface,
-                   const std::any& holder)
+                   const InterfaceHolder& holder)
     {
-        const auto& object = *std::any_cast<const std::shared_ptr<T>&>(holder);
+        const auto& object = holder.get<T>();
         Ops::serialize(path, iface, object);
     }
 };
@@ -134,7 +293,8 @@ struct SerializeInterface<T, Ops, std::enable_if_t<HasProperties<T>::value>>
 template <typename T, typename Ops, typename Enable = void>
 struct DeserializeInterface
 {
-    static void op(const std::string& path, const std::string& iface, std::any&)
+    static void op(const std::string& path, const std::string& iface,
+                   InterfaceHolder&)
     {
         Ops::deserialize(path, iface);
     }
@@ -144,9 +304,9 @@ template <typename T, typename Ops>
 struct DeserializeInterface<T, Ops, std::enable_if_t<HasProperties<T>::value>>
 {
     static void op(const std::string& path, const std::string& iface,
-                   std::any& holder)
+                   InterfaceHolder& holder)
     {
-        auto& object = *std::any_cast<std::shared_ptr<T>&>(holder);
+        auto& object = holder.get<T>();
         Ops::deserialize(path, iface, object);
     }
 };
@@ -166,6 +326,12 @@ using DeserializeInterfaceType =
 using GetPropertyValueType =
     std::add_pointer_t<decltype(GetPropertyValue<DummyInterface>::op)>;
 
+/** @brief Reads all of a binding's properties.
+ *
+ *  pimgen binds each interface's property names to GetProperties.
+ */
+using GetPropertiesType = Interface (*)(InterfaceHolder&);
+
 } // namespace manager
 } // namespace inventory
 } // namespace phosphor
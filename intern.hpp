@@ -0,0 +1,251 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+/** @class Interned
+ *  @brief A handle to a string in the process-wide intern pool.
+ *
+ *  Equal strings are kept once, however many handles refer to them, so
+ *  association paths and types, and property values repeated across
+ *  objects, cost a pointer each.  A string with a single user is better
+ *  kept as a std::string, as pooling it only adds a pool node.  Handles
+ *  are copied and compared for equality as pointers, and order as the
+ *  strings do.
+ *
+ *  Pooled strings are counted by their handles and released with the
+ *  last one, so paths and values of objects that go away don't
+ *  accumulate.  Copies take no lock, and releases only lock the pool
+ *  to drop a string.
+ */
+class Interned
+{
+  public:
+    /** @brief The empty string. */
+    Interned() noexcept : _e(&empty()) {}
+
+    /** @brief Intern a string.
+     *
+     *  @param[in] s - The string.
+     */
+    explicit Interned(std::string_view s) : _e(intern(s)) {}
+
+    Interned(const Interned& o) noexcept : _e(o._e)
+    {
+        acquire();
+    }
+
+    /** @brief Take over a handle, leaving the empty string behind. */
+    Interned(Interned&& o) noexcept : _e(std::exchange(o._e, &empty())) {}
+
+    Interned& operator=(const Interned& o) noexcept
+    {
+        // Acquire first, so assigning a handle to the same string can't
+        // release it.
+        o.acquire();
+        release();
+        _e = o._e;
+        return *this;
+    }
+
+    Interned& operator=(Interned&& o) noexcept
+    {
+        if (this != &o)
+        {
+            release();
+            _e = std::exchange(o._e, &empty());
+        }
+        return *this;
+    }
+
+    ~Interned()
+    {
+        release();
+    }
+
+    /** @brief The string. */
+    const std::string& str() const noexcept
+    {
+        return _e->first;
+    }
+
+    const char* c_str() const noexcept
+    {
+        return _e->first.c_str();
+    }
+
+    operator const std::string&() const noexcept
+    {
+        return _e->first;
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return _e->first;
+    }
+
+    friend bool operator==(const Interned& l, const Interned& r) noexcept
+    {
+        return l._e == r._e;
+    }
+
+    friend std::strong_ordering operator<=>(const Interned& l,
+                                            const Interned& r) noexcept
+    {
+        return l._e == r._e ? std::strong_ordering::equal
+                            : std::string_view(l.str()) <=> r.str();
+    }
+
+    friend bool operator==(const Interned& l, std::string_view r) noexcept
+    {
+        return l.str() == r;
+    }
+
+    friend std::strong_ordering operator<=>(const Interned& l,
+                                            std::string_view r) noexcept
+    {
+        return std::string_view(l.str()) <=> r;
+    }
+
+    friend std::ostream& operator<<(std::ostream& o, const Interned& s)
+    {
+        return o << s.str();
+    }
+
+    /** @brief The number of distinct strings in the pool, not counting
+     *      the empty string.
+     */
+    static std::size_t count()
+    {
+        auto& p = pool();
+        std::lock_guard lock{p.mutex};
+        return p.strings.size();
+    }
+
+  private:
+    /** @brief Heterogeneous hashing, so lookups don't build a string. */
+    struct Hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view s) const noexcept
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    /** @brief The pool, shared by every thread.  Each string is kept
+     *      with the number of handles to it.
+     */
+    struct Pool
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::atomic<std::size_t>, Hash,
+                           std::equal_to<>>
+            strings;
+    };
+
+    using Entry = std::pair<const std::string, std::atomic<std::size_t>>;
+
+    static Pool& pool()
+    {
+        static Pool p;
+        return p;
+    }
+
+    /** @brief The empty string, kept outside the pool and never counted,
+     *      so default and moved-from handles don't touch the pool.
+     */
+    static Entry& empty() noexcept
+    {
+        static Entry e{std::string(), 0};
+        return e;
+    }
+
+    /** @brief Find or add a string, and count a handle to it.  Map nodes
+     *      don't move, so the entry stays valid until it is released.
+     */
+    static Entry* intern(std::string_view s)
+    {
+        if (s.empty())
+        {
+            return &empty();
+        }
+
+        auto& p = pool();
+        std::lock_guard lock{p.mutex};
+        auto it = p.strings.find(s);
+        if (it == p.strings.end())
+        {
+            it = p.strings.try_emplace(std::string(s), 0).first;
+        }
+        ++it->second;
+        return &*it;
+    }
+
+    /** @brief Count another handle.  This handle holds the string, so it
+     *      can't be released meanwhile and no lock is needed.
+     */
+    void acquire() const noexcept
+    {
+        if (_e != &empty())
+        {
+            _e->second.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /** @brief Uncount this handle, and drop the string with the last one.
+     *
+     *  While other handles remain the count drops without the lock.  The
+     *  last handle drops it under the lock, so intern() can't find the
+     *  string between the count reaching zero and the string being
+     *  dropped.  The count is checked again there, as intern() or a copy
+     *  may have added a handle meanwhile.
+     */
+    void release() noexcept
+    {
+        if (_e == &empty())
+        {
+            return;
+        }
+
+        auto n = _e->second.load(std::memory_order_relaxed);
+        while (n > 1)
+        {
+            if (_e->second.compare_exchange_weak(n, n - 1,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+
+        auto& p = pool();
+        std::lock_guard lock{p.mutex};
+        if (_e->second.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            p.strings.erase(p.strings.find(_e->first));
+        }
+    }
+
+    Entry* _e;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -17,11 +17,25 @@
 
 #include "errors.hpp"
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
+#include <xyz/openbmc_project/Common/error.hpp>
+
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <exception>
-#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
+#include <system_error>
 
 using namespace std::literals::chrono_literals;
 
@@ -31,6 +45,47 @@ namespace inventory
 {
 namespace manager
 {
+namespace
+{
+/** @brief The most queued objects applied per event loop iteration. */
+constexpr std::size_t notifyBatch = 64;
+
+/** @brief The most objects looked at for one page of results, unless
+ *      the page is larger.
+ */
+constexpr std::size_t pageScanLimit = 1024;
+
+/** @brief Event source priorities, highest first.
+ *
+ *  Bus messages, including reads like Get and GetManagedObjects, go
+ *  ahead of applying queued Notify updates, which go ahead of running
+ *  event actions.
+ */
+constexpr auto busPriority = SD_EVENT_PRIORITY_NORMAL;
+constexpr auto writePriority = SD_EVENT_PRIORITY_NORMAL + 1;
+constexpr auto actionPriority = SD_EVENT_PRIORITY_NORMAL + 2;
+
+/** @brief Find the holder of an interface in an InterfaceComposite.
+ *
+ *  @param[in] composite - The interfaces of an object.
+ *  @param[in] id - The ID of the interface to find.
+ *
+ *  @returns An iterator to the holder, or composite.end().
+ */
+template <typename Composite, typename Id>
+auto findInterface(Composite& composite, Id id)
+{
+    auto it = std::lower_bound(composite.begin(), composite.end(), id,
+                               compareFirst(std::less<>()));
+    if (it != composite.end() && it->first != id)
+    {
+        return composite.end();
+    }
+
+    return it;
+}
+} // namespace
+
 /** @brief Fowrarding signal callback.
  *
  *  Extracts per-signal specific context and forwards the call to the manager
@@ -57,12 +112,213 @@ auto _signal(sd_bus_message* m, void* data, sd_bus_error* /* e */) noexcept
 
 Manager::Manager(sdbusplus::bus_t&& bus, const char* root) :
     ServerObject<ManagerIface>(bus, root), _root(root), _bus(std::move(bus)),
-    _manager(_bus, root),
+    _manager(_bus, root), _extensions(_bus, root, *this),
+    _event(sdeventplus::Event::get_default()),
+    _signalTimer(_event,
+                 [this](auto&) {
+                     try
+                     {
+                         flushSignals();
+                     }
+                     catch (const std::exception& e)
+                     {
+                         lg2::error("Failed to flush signals: {ERROR}",
+                                    "ERROR", e);
+                     }
+                 }),
+    _transactionTimer(_event,
+                      [this](auto&) {
+                          lg2::warning("Committing a transaction left open "
+                                       "for {SECONDS}s",
+                                       "SECONDS", TRANSACTION_TIMEOUT_S);
+                          try
+                          {
+                              drainQueue();
+                              finishTransaction();
+                          }
+                          catch (const std::exception& e)
+                          {
+                              lg2::error("Failed to commit: {ERROR}", "ERROR",
+                                         e);
+                          }
+                      }),
+    _drainSource(_event,
+                 [this](auto& source) {
+                     try
+                     {
+                         drainQueue(notifyBatch);
+                     }
+                     catch (const std::exception& e)
+                     {
+                         lg2::error("Failed to apply queued updates: {ERROR}",
+                                    "ERROR", e);
+                     }
+                     if (_queued.empty())
+                     {
+                         source.set_enabled(sdeventplus::source::Enabled::Off);
+                     }
+                 }),
+    _actionSource(_event,
+                  [this](auto& source) {
+                      runActions(std::chrono::microseconds(ACTION_SLICE_US));
+                      if (_actionJobs.empty())
+                      {
+                          source.set_enabled(
+                              sdeventplus::source::Enabled::Off);
+                      }
+                  }),
+    _wakeupSource(_event, _wakeup.fd, EPOLLIN,
+                  [this](auto&, auto, auto) {
+                      std::uint64_t count = 0;
+                      [[maybe_unused]] auto r =
+                          read(_wakeup.fd, &count, sizeof(count));
+                  }),
+#ifndef COMPACT_STORE
+    _writtenSource(_event,
+                   [this](auto& source) {
+                       source.set_enabled(sdeventplus::source::Enabled::Off);
+                       auto written = std::move(_written);
+                       _written.clear();
+                       try
+                       {
+                           for (const auto& [path, ids] : written)
+                           {
+                               for (auto id : ids)
+                               {
+                                   propertiesWritten(path, id);
+                               }
+                           }
+                           publishSnapshot();
+                       }
+                       catch (const std::exception& e)
+                       {
+                           lg2::error("Failed to persist properties set over "
+                                      "DBus: {ERROR}",
+                                      "ERROR", e);
+                       }
+                   }),
+#endif
 #ifdef CREATE_ASSOCIATIONS
     _associations(_bus),
 #endif
     _status(ManagerStatus::STARTING)
 {
+    _bus.attach_event(_event.get(), busPriority);
+    _drainSource.set_priority(writePriority);
+    _drainSource.set_enabled(sdeventplus::source::Enabled::Off);
+    _actionSource.set_priority(actionPriority);
+    _actionSource.set_enabled(sdeventplus::source::Enabled::Off);
+
+#ifndef COMPACT_STORE
+    // The bindings handle Set themselves, so the requests are noted on
+    // the way in.
+    _writtenSource.set_priority(busPriority);
+    _writtenSource.set_enabled(sdeventplus::source::Enabled::Off);
+    sd_bus_slot* slot = nullptr;
+    auto r = sd_bus_add_filter(_bus.get(), &slot, noteWrite, this);
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, "sd_bus_add_filter");
+    }
+    _writeFilter = sdbusplus::slot_t(slot);
+#endif
+
+#ifdef SHARED_VIEW
+    try
+    {
+        fs::create_directories(fs::path(view::defaultPath).parent_path());
+        _sharedView = std::make_unique<view::Writer>(view::defaultPath);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to create the shared inventory view: {ERROR}",
+                   "ERROR", e);
+    }
+#endif
+
+    std::string_view shards{PERSIST_SHARDS};
+    if (!shards.empty())
+    {
+        std::vector<std::string> roots;
+        for (auto shard : std::views::split(shards, ','))
+        {
+            roots.emplace_back(_root).append(std::string_view(shard));
+        }
+        _persistWorkers = std::make_unique<PersistWorkers>(roots);
+        SerialOps::workers = _persistWorkers.get();
+    }
+
+#ifdef COMPACT_STORE
+    _compactServer = std::make_unique<compact::Server>(
+        _bus, _root, _compactInfo,
+        [this](std::string_view path,
+               std::size_t id) -> compact::Values* {
+            auto it = _refs.find(path);
+            if (it == _refs.end())
+            {
+                return nullptr;
+            }
+            auto iface = findInterface(it->second, id);
+            if (iface == it->second.end())
+            {
+                return nullptr;
+            }
+            return &_compactInfo[id]->values(iface->second);
+        },
+        [this](std::string_view prefix) {
+            std::string p{prefix};
+            while (p.ends_with('/'))
+            {
+                p.pop_back();
+            }
+
+            // As in getObjects(), the paths below p sort from "<p>/" up
+            // to "<p>0".
+            p.push_back('/');
+            auto it = _refs.lower_bound(p);
+            p.back() = '/' + 1;
+            auto last = _refs.lower_bound(p);
+
+            std::vector<std::string> paths;
+            for (; it != last; ++it)
+            {
+                paths.push_back(it->first);
+            }
+            return paths;
+        },
+        [this](std::string_view path, std::size_t id, const char* property,
+               InterfaceVariantType&& value) {
+            std::string relPath{path.substr(std::strlen(_root))};
+            setPropertyValue(relPath.c_str(), _compactInfo[id]->name,
+                             property, std::move(value));
+            propertiesWritten(std::string(path), id);
+            publishSnapshot();
+        });
+#endif
+
+    if (!std::string_view(PEER_SOCKET).empty())
+    {
+        try
+        {
+            fs::create_directories(fs::path(PEER_SOCKET).parent_path());
+            _peerServer =
+                std::make_unique<PeerServer>(_event, PEER_SOCKET, _root, *this);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to listen on {PATH}: {ERROR}", "PATH",
+                       PEER_SOCKET, "ERROR", e);
+        }
+    }
+
+    for (const auto& [interface, properties] : _indexConfig)
+    {
+        if (auto id = interfaceId(interface))
+        {
+            _indexes.emplace(*id, InterfaceIndex(properties));
+        }
+    }
+
     for (auto& group : _events)
     {
         for (auto pEvent : std::get<std::vector<EventBasePtr>>(group))
@@ -93,9 +349,32 @@ Manager::Manager(sdbusplus::bus_t&& bus, const char* root) :
     restore();
 }
 
+Manager::~Manager()
+{
+    SerialOps::workers = nullptr;
+}
+
+Manager::Wakeup::Wakeup() : fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+}
+
+Manager::Wakeup::~Wakeup()
+{
+    close(fd);
+}
+
 void Manager::shutdown() noexcept
 {
     _status = ManagerStatus::STOPPING;
+
+    // The loop waits without a timeout, so it is woken to see the
+    // status.
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto r = write(_wakeup.fd, &one, sizeof(one));
 }
 
 void Manager::run(const char* busname)
@@ -114,40 +393,93 @@ void Manager::run(const char* busname)
         }
     }
 
+    // Startup events complete before the inventory is published.
+    while (_eventsInFlight)
+    {
+        iterate();
+    }
+
     _status = ManagerStatus::RUNNING;
     _bus.request_name(busname);
 
-    while (_status != ManagerStatus::STOPPING)
+    // Once stopping, no new events start, but those in flight finish.
+    while (_status != ManagerStatus::STOPPING || _eventsInFlight)
     {
         try
         {
-            _bus.process_discard();
-            _bus.wait((5000000us).count());
+            iterate();
         }
         catch (const std::exception& e)
         {
             std::cerr << e.what() << std::endl;
         }
     }
+
+    drainQueue();
+    if (_transaction.depth)
+    {
+        finishTransaction();
+    }
+    flushSignals();
+}
+
+void Manager::iterate()
+{
+    // Run one sd-event iteration by hand so the dispatch can be timed
+    // apart from the wait.
+    auto r = _event.prepare();
+    if (r == 0)
+    {
+        r = _event.wait(std::nullopt);
+    }
+    if (r <= 0)
+    {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    _event.dispatch();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    ++_statistics.loopIterations;
+    _statistics.loopDispatchUs += elapsed;
+    _statistics.loopDispatchMaxUs =
+        std::max<std::uint64_t>(_statistics.loopDispatchMaxUs, elapsed);
 }
 
 void Manager::updateInterfaces(
-    const sdbusplus::object_path& path, const Object& interfaces,
+    const std::string& path, Object&& interfaces,
     ObjectReferences::iterator pos, bool newObject, bool restoreFromCache)
 {
     auto& refaces = pos->second;
-    auto ifaceit = interfaces.cbegin();
+    auto ifaceit = interfaces.begin();
     auto opsit = _makers.cbegin();
     auto refaceit = refaces.begin();
-    std::vector<std::string> signals;
+    const auto rootSize = std::strlen(_root);
+
+    // Signals are only sent once the manager is running, and then they
+    // are held so that updates to the same object can be coalesced.
+    PendingSignals* pending = nullptr;
+    if (_status == ManagerStatus::RUNNING)
+    {
+        if (SIGNAL_COALESCE_MS && _pendingSignals.empty())
+        {
+            _signalTimer.restartOnce(
+                std::chrono::milliseconds(SIGNAL_COALESCE_MS));
+        }
+        pending = &_pendingSignals[path];
+        pending->objectAdded |= newObject;
+    }
 
-    while (ifaceit != interfaces.cend())
+    while (ifaceit != interfaces.end())
     {
         try
         {
             // Find the binding ops for this interface.
             opsit = std::lower_bound(opsit, _makers.cend(), ifaceit->first,
-                                     compareFirst(_makers.key_comp()));
+                                     compareFirst(std::less<>()));
 
             if (opsit == _makers.cend() || opsit->first != ifaceit->first)
             {
@@ -156,31 +488,125 @@ void Manager::updateInterfaces(
                                      ifaceit->first);
             }
 
+            auto id = static_cast<InterfaceId>(opsit - _makers.cbegin());
+            auto unchanged = false;
+            auto index = _indexes.find(id);
+            auto added = false;
+
             // Find the binding insertion point or the binding to update.
-            refaceit = std::lower_bound(refaceit, refaces.end(), ifaceit->first,
-                                        compareFirst(refaces.key_comp()));
+            // Interface IDs sort like interface names, so the search can
+            // resume from the previous interface.
+            refaceit = std::lower_bound(refaceit, refaces.end(), id,
+                                        compareFirst(std::less<>()));
 
-            if (refaceit == refaces.end() || refaceit->first != ifaceit->first)
+            if (refaceit == refaces.end() || refaceit->first != id)
             {
                 // Add the new interface.
+#ifdef DYNAMIC_INTERFACES
+                refaceit = refaces.emplace(
+                    refaceit, id,
+                    InterfaceHolder::make<compact::Dynamic>(
+                        *_compactInfo[id], ifaceit->second));
+#else
                 auto& ctor = std::get<MakeInterfaceType>(opsit->second);
                 // skipSignal = true here to avoid getting PropertiesChanged
                 // signals while the interface is constructed.  We'll emit an
-                // ObjectManager signal for this interface below.
-                refaceit = refaces.insert(
-                    refaceit, std::make_pair(ifaceit->first,
-                                             ctor(_bus, path.str.c_str(),
-                                                  ifaceit->second, true)));
-                signals.push_back(ifaceit->first);
+                // ObjectManager signal for this interface when flushing.
+                refaceit = refaces.emplace(
+                    refaceit, id,
+                    ctor(_bus, path.c_str(), std::move(ifaceit->second),
+                         true));
+#endif
+                snapshotChanged(path, id);
+                added = true;
+                if (pending && !pending->objectAdded)
+                {
+                    pending->added.push_back(id);
+                }
             }
             else
             {
-                // Set the new property values.
+                // Set the new property values.  PropertiesChanged is
+                // deferred to the flush as well.
                 auto& assign = std::get<AssignInterfaceType>(opsit->second);
-                assign(ifaceit->second, refaceit->second,
-                       _status != ManagerStatus::RUNNING);
+                auto received = ifaceit->second.size();
+
+                // Keep the received values of indexed properties, since
+                // assigning moves them.
+                std::vector<std::pair<std::size_t, InterfaceVariantType>>
+                    indexed;
+                if (index != _indexes.end())
+                {
+                    for (std::size_t i = 0; i < index->second.properties();
+                         ++i)
+                    {
+                        auto p =
+                            ifaceit->second.find(index->second.property(i));
+                        if (p != ifaceit->second.end())
+                        {
+                            indexed.emplace_back(i, p->second);
+                        }
+                    }
+                }
+
+                auto changed = assign(std::move(ifaceit->second),
+                                      refaceit->second, true);
+                _statistics.propertiesReceived += received;
+                _statistics.propertiesUnchanged += received - changed.size();
+                unchanged = changed.empty();
+                if (!unchanged)
+                {
+                    snapshotChanged(path, id);
+                }
+                for (const auto& [i, value] : indexed)
+                {
+                    const auto& name = index->second.property(i);
+                    if (std::ranges::find(changed, name) != changed.end())
+                    {
+                        index->second.set(
+                            i, std::string_view(path).substr(rootSize),
+                            value);
+                    }
+                }
+                if (pending && !pending->objectAdded && !changed.empty() &&
+                    std::ranges::find(pending->added, id) ==
+                        pending->added.end())
+                {
+                    auto it = std::ranges::find(
+                        pending->changed, id,
+                        &decltype(pending->changed)::value_type::first);
+                    if (it == pending->changed.end())
+                    {
+                        pending->changed.emplace_back(id, std::move(changed));
+                    }
+                    else
+                    {
+                        for (auto& name : changed)
+                        {
+                            if (std::ranges::find(it->second, name) ==
+                                it->second.end())
+                            {
+                                it->second.push_back(std::move(name));
+                            }
+                        }
+                    }
+                }
+            }
+            if (unchanged)
+            {
+                // Nothing new to persist.
+                ++_statistics.serializationsSkipped;
+            }
+            else if (!restoreFromCache && _transaction.depth)
+            {
+                // Persist once, when the transaction is committed.
+                auto& unsaved = _transaction.unsaved[path];
+                if (std::ranges::find(unsaved, id) == unsaved.end())
+                {
+                    unsaved.push_back(id);
+                }
             }
-            if (!restoreFromCache)
+            else if (!restoreFromCache)
             {
                 auto& serialize =
                     std::get<SerializeInterfaceType<SerialOps>>(opsit->second);
@@ -193,6 +619,13 @@ void Manager::updateInterfaces(
                         opsit->second);
                 deserialize(path, ifaceit->first, refaceit->second);
             }
+
+            if (added && index != _indexes.end())
+            {
+                indexInterface(index->second,
+                               std::string_view(path).substr(rootSize), id,
+                               refaceit->second);
+            }
         }
         catch (const InterfaceError& e)
         {
@@ -204,16 +637,68 @@ void Manager::updateInterfaces(
 
         ++ifaceit;
     }
+}
 
-    if (_status == ManagerStatus::RUNNING)
+void Manager::flushSignals()
+{
+    if (_pendingSignals.empty() || _transaction.depth)
+    {
+        return;
+    }
+    _signalTimer.setEnabled(false);
+
+    // Take the pending signals so a failure part way through does not
+    // repeat what was already sent.
+    auto pending = std::move(_pendingSignals);
+    _pendingSignals.clear();
+
+    std::vector<std::string> interfaces;
+    std::vector<char*> properties;
+    for (const auto& [path, signals] : pending)
     {
-        if (newObject)
+        try
         {
-            _bus.emit_object_added(path.str.c_str());
+            if (signals.objectAdded)
+            {
+                _bus.emit_object_added(path.c_str());
+                continue;
+            }
+
+            if (!signals.added.empty())
+            {
+                interfaces.clear();
+                for (auto id : signals.added)
+                {
+                    interfaces.push_back(_makers[id].first);
+                }
+                _bus.emit_interfaces_added(path.c_str(), interfaces);
+            }
+
+            for (const auto& [id, names] : signals.changed)
+            {
+                properties.clear();
+                for (const auto& name : names)
+                {
+                    properties.push_back(const_cast<char*>(name.c_str()));
+                }
+                properties.push_back(nullptr);
+
+                auto r = sd_bus_emit_properties_changed_strv(
+                    _bus.get(), path.c_str(), _makers[id].first.c_str(),
+                    properties.data());
+                if (r < 0)
+                {
+                    lg2::error("Failed to emit PropertiesChanged for "
+                               "{INTERFACE} on {PATH}: {ERROR}",
+                               "INTERFACE", _makers[id].first, "PATH", path,
+                               "ERROR", strerror(-r));
+                }
+            }
         }
-        else if (!signals.empty())
+        catch (const std::exception& e)
         {
-            _bus.emit_interfaces_added(path.str.c_str(), signals);
+            lg2::error("Failed to emit signals for {PATH}: {ERROR}", "PATH",
+                       path, "ERROR", e);
         }
     }
 }
@@ -221,210 +706,1310 @@ void Manager::updateInterfaces(
 void Manager::updateObjects(
     const std::map<sdbusplus::object_path, Object>& objs, bool restoreFromCache)
 {
-    auto objit = objs.cbegin();
-    auto refit = _refs.begin();
-    std::string absPath;
-    bool newObj;
+    auto copy = objs;
+    updateObjects(std::move(copy), restoreFromCache);
+}
 
-    while (objit != objs.cend())
+void Manager::updateObjects(std::map<sdbusplus::object_path, Object>&& objs,
+                            bool restoreFromCache)
+{
+    for (auto& [path, object] : objs)
     {
-        // Find the insertion point or the object to update.
-        refit = std::lower_bound(refit, _refs.end(), objit->first,
-                                 compareFirst(RelPathCompare(_root)));
+        updateObject(path.str, std::move(object), restoreFromCache);
+    }
+    finishUpdate();
+}
 
-        absPath.assign(_root);
-        absPath.append(objit->first);
+void Manager::updateObject(std::string_view path, Object&& interfaces,
+                           bool restoreFromCache)
+{
+    // Find the insertion point or the object to update.  Existing
+    // objects are found without building their absolute path.
+    RootedPath rooted{_root, path};
+    auto refit = _refs.lower_bound(rooted);
 
-        newObj = false;
-        if (refit == _refs.end() || refit->first != absPath)
-        {
-            refit = _refs.insert(
-                refit, std::make_pair(absPath, decltype(_refs)::mapped_type()));
-            newObj = true;
-        }
+    auto newObj = false;
+    if (refit == _refs.end() || PathCompare::compare(refit->first, rooted) != 0)
+    {
+        std::string absPath{_root};
+        absPath.append(path);
+        refit = _refs.emplace_hint(refit, std::move(absPath),
+                                   InterfaceComposite());
+        newObj = true;
+    }
 
-        updateInterfaces(absPath, objit->second, refit, newObj,
-                         restoreFromCache);
 #ifdef CREATE_ASSOCIATIONS
-        if (!_associations.pendingCondition() && newObj)
-        {
-            _associations.createAssociations(absPath,
-                                             _status != ManagerStatus::RUNNING);
-        }
-        else if (!restoreFromCache &&
-                 _associations.conditionMatch(objit->first, objit->second))
+    // Test the association conditions before the property values
+    // are moved into the bindings.  Transactions test them against
+    // the bindings on commit instead.
+    auto pendingCondition = _associations.pendingCondition();
+    auto conditionMatch = !restoreFromCache && pendingCondition &&
+                          !_transaction.depth &&
+                          _associations.conditionMatch(path, interfaces);
+#endif
+
+    const auto& absPath = refit->first;
+    updateInterfaces(absPath, std::move(interfaces), refit, newObj,
+                     restoreFromCache);
+#ifdef CREATE_ASSOCIATIONS
+    if (_transaction.depth && !restoreFromCache)
+    {
+        if (newObj)
         {
-            // The objit path/interface/property matched a pending condition.
-            // Now the associations are valid so attempt to create them against
-            // all existing objects.  If this was the restoreFromCache path,
-            // objit doesn't contain property values so don't bother checking.
-            std::for_each(_refs.begin(), _refs.end(), [this](const auto& ref) {
-                _associations.createAssociations(
-                    ref.first, _status != ManagerStatus::RUNNING);
-            });
+            _transaction.created.push_back(absPath);
         }
-#endif
-        ++objit;
     }
+    else if (!pendingCondition && newObj)
+    {
+        _associations.createAssociations(absPath,
+                                         _status != ManagerStatus::RUNNING);
+    }
+    else if (conditionMatch)
+    {
+        // The path/interface/property matched a pending condition.
+        // Now the associations are valid so attempt to create them against
+        // all existing objects.  If this was the restoreFromCache path,
+        // the object doesn't contain property values so don't bother
+        // checking.
+        std::for_each(_refs.begin(), _refs.end(), [this](const auto& ref) {
+            _associations.createAssociations(
+                ref.first, _status != ManagerStatus::RUNNING);
+        });
+    }
+#endif
 }
 
-void Manager::notify(std::map<sdbusplus::object_path, Object> objs)
+void Manager::finishUpdate()
 {
-    updateObjects(objs);
+    // Without a coalescing window the signals go out with each update,
+    // otherwise _signalTimer sends them.
+    if (!SIGNAL_COALESCE_MS)
+    {
+        flushSignals();
+    }
+    publishSnapshot();
 }
 
-void Manager::handleEvent(sdbusplus::message_t& msg, const Event& event,
-                          const EventInfo& info)
+void Manager::notify(NotifyObjects objs)
 {
-    auto& actions = std::get<1>(info);
-
-    for (auto& f : event)
+    if (NOTIFY_QUEUE_LIMIT)
     {
-        if (!f(_bus, msg, *this))
+        // Make producers back off rather than queueing without bound.
+        auto added = std::ranges::count_if(objs, [this](const auto& obj) {
+            return !_queued.contains(obj.first);
+        });
+        if (!queueAdmits(_queued.size(), added, NOTIFY_QUEUE_LIMIT))
         {
-            return;
+            ++_statistics.notifyRejected;
+            throw sdbusplus::xyz::openbmc_project::Common::Error::
+                Unavailable();
         }
     }
-    for (auto& action : actions)
+
+    // The binding decodes into std::map; move everything into the flat
+    // transport types.  Extracting the nodes lets the keys move rather
+    // than be copied, and as the source maps are already sorted, each
+    // emplace is an append.
+    std::map<sdbusplus::object_path, Object> objects;
+    while (!objs.empty())
     {
-        action(_bus, *this);
+        auto objNode = objs.extract(objs.begin());
+        auto& interfaces = objNode.mapped();
+        Object object;
+        object.reserve(interfaces.size());
+        while (!interfaces.empty())
+        {
+            auto ifaceNode = interfaces.extract(interfaces.begin());
+            auto& properties = ifaceNode.mapped();
+            Interface interface;
+            interface.reserve(properties.size());
+            while (!properties.empty())
+            {
+                auto propNode = properties.extract(properties.begin());
+                interface.emplace(std::move(propNode.key()),
+                                  std::move(propNode.mapped()));
+            }
+            object.emplace(std::move(ifaceNode.key()), std::move(interface));
+        }
+        objects.emplace_hint(objects.end(), std::move(objNode.key()),
+                             std::move(object));
     }
-}
-
-void Manager::destroyObjects(const std::vector<const char*>& paths)
-{
-    std::string p;
 
-    for (const auto& path : paths)
+    if (!NOTIFY_QUEUE_LIMIT)
     {
-        p.assign(_root);
-        p.append(path);
-        _bus.emit_object_removed(p.c_str());
-        _refs.erase(p);
+        updateObjects(std::move(objects));
+        return;
     }
-}
 
-void Manager::createObjects(
-    const std::map<sdbusplus::object_path, Object>& objs)
-{
-    updateObjects(objs);
-}
+    // Queue the update, merging it with any update still queued for the
+    // same object.  The queue is applied when the loop is otherwise idle.
+    _drainSource.set_enabled(sdeventplus::source::Enabled::On);
+    while (!objects.empty())
+    {
+        auto [pos, inserted, node] =
+            _queued.insert(objects.extract(objects.begin()));
+        if (inserted)
+        {
+            continue;
+        }
 
-std::any& Manager::getInterfaceHolder(const char* path, const char* interface)
-{
-    return const_cast<std::any&>(
-        const_cast<const Manager*>(this)->getInterfaceHolder(path, interface));
+        auto& queued = pos->second;
+        for (auto& [name, interface] : node.mapped())
+        {
+            auto queuedIface = queued.find(name);
+            if (queuedIface == queued.end())
+            {
+                queued.emplace(std::move(name), std::move(interface));
+                continue;
+            }
+
+            for (auto& [property, value] : interface)
+            {
+                auto queuedValue = queuedIface->second.find(property);
+                if (queuedValue == queuedIface->second.end())
+                {
+                    queuedIface->second.emplace(std::move(property),
+                                                std::move(value));
+                }
+                else
+                {
+                    queuedValue->second = std::move(value);
+                    ++_statistics.notifySuperseded;
+                }
+            }
+        }
+    }
 }
 
-const std::any& Manager::getInterfaceHolder(const char* path,
-                                            const char* interface) const
+void Manager::drainQueue(std::size_t limit)
 {
-    std::string p{path};
-    auto oit = _refs.find(_root + p);
-    if (oit == _refs.end())
-        throw std::runtime_error(_root + p + " was not found");
+    if (_queued.empty())
+    {
+        return;
+    }
 
-    auto& obj = oit->second;
-    auto iit = obj.find(interface);
-    if (iit == obj.end())
-        throw std::runtime_error("interface was not found");
+    std::map<sdbusplus::object_path, Object> batch;
+    while (!_queued.empty() && batch.size() < limit)
+    {
+        batch.insert(batch.end(), _queued.extract(_queued.begin()));
+    }
 
-    return iit->second;
+    // Notify has already returned, so there is nobody to report a
+    // failure to.  Each object is applied on its own, and one that
+    // fails is logged against its path without holding back the rest.
+    for (auto& [path, object] : batch)
+    {
+        try
+        {
+            updateObject(path.str, std::move(object), false);
+        }
+        catch (const std::exception& e)
+        {
+            ++_statistics.notifyFailed;
+            lg2::error("Failed to apply queued update to {PATH}: {ERROR}",
+                       "PATH", path.str, "ERROR", e);
+        }
+    }
+    finishUpdate();
 }
 
-void Manager::restore()
+void Manager::handleEvent(sdbusplus::message_t& msg, const Event& event,
+                          const EventInfo& info)
 {
-    namespace fs = std::filesystem;
-
-    if (!fs::exists(fs::path(PIM_PERSIST_PATH)))
+    if (_status == ManagerStatus::STOPPING)
     {
         return;
     }
 
-    static const std::string remove =
-        std::string(PIM_PERSIST_PATH) + INVENTORY_ROOT;
+    // Events act on the inventory as the producers left it.
+    drainQueue();
 
-    std::map<sdbusplus::object_path, Object> objects;
-    for (const auto& dirent :
-         fs::recursive_directory_iterator(PIM_PERSIST_PATH))
+    ++_eventsInFlight;
+    spawn(runEvent(msg, event, info));
+}
+
+Task<> Manager::runEvent(sdbusplus::message_t msg, const Event& event,
+                         const EventInfo& info)
+{
+    try
     {
-        const auto& path = dirent.path();
-        if (fs::is_regular_file(path))
+        // Filters examine the message, so the first runs right away.
+        auto matched = true;
+        for (auto& f : event)
         {
-            auto ifaceName = path.filename().string();
-            auto objPath = path.parent_path().string();
-            objPath.erase(0, remove.length());
-            auto objit = objects.find(objPath);
-            Interface propertyMap{};
-            if (objects.end() != objit)
+            if (!co_await f(_bus, msg, *this))
             {
-                auto& object = objit->second;
-                object.emplace(std::move(ifaceName), std::move(propertyMap));
+                matched = false;
+                break;
             }
-            else
+        }
+
+        // The actions run in turn, each waiting behind bus messages
+        // and updates.
+        if (matched)
+        {
+            for (auto& action : std::get<1>(info))
             {
-                Object object;
-                object.emplace(std::move(ifaceName), std::move(propertyMap));
-                objects.emplace(std::move(objPath), std::move(object));
+                co_await ActionTurn{*this};
+                co_await action(_bus, *this);
+                ++_statistics.actionsRun;
+                publishSnapshot();
             }
         }
     }
-    if (!objects.empty())
+    catch (const std::exception& e)
     {
-        auto restoreFromCache = true;
-        updateObjects(objects, restoreFromCache);
+        // A failure ends the event's action list.
+        lg2::error("Event handling failed: {ERROR}", "ERROR", e);
+    }
 
-#ifdef CREATE_ASSOCIATIONS
-        // There may be conditional associations waiting to be loaded
-        // based on certain path/interface/property values.  Now that
-        // _refs contains all objects with their property values, check
-        // which property values the conditions need and set them in the
-        // condition structure entries, using the actualValue field.  Then
-        // the associations manager can check if the conditions are met.
-        if (_associations.pendingCondition())
-        {
-            ObjectReferences::iterator refIt;
-            InterfaceComposite::iterator ifaceIt;
-
-            auto& conditions = _associations.getConditions();
-            for (auto& condition : conditions)
-            {
-                refIt = _refs.find(_root + condition.path);
-                if (refIt != _refs.end())
+    --_eventsInFlight;
+}
+
+void Manager::runActions(std::chrono::steady_clock::duration budget)
+{
+    auto start = std::chrono::steady_clock::now();
+    while (!_actionJobs.empty())
+    {
+        auto job = _actionJobs.front();
+        _actionJobs.pop_front();
+        job.resume();
+
+        if (std::chrono::steady_clock::now() - start >= budget)
+        {
+            if (!_actionJobs.empty())
+            {
+                ++_statistics.actionSlicesYielded;
+            }
+            break;
+        }
+    }
+}
+
+void Manager::destroyObjects(const std::vector<const char*>& paths)
+{
+    std::string p;
+
+    for (const auto& path : paths)
+    {
+        p.assign(_root);
+        p.append(path);
+        emitObjectRemoved(p);
+        if (auto it = _refs.find(p); it != _refs.end())
+        {
+            unindexObject(*it);
+            _refs.erase(it);
+            snapshotChanged(p, std::nullopt);
+        }
+    }
+    publishSnapshot();
+}
+
+void Manager::destroySubtree(const char* path)
+{
+    std::string p{_root};
+    p.append(path);
+    while (p.ends_with('/'))
+    {
+        p.pop_back();
+    }
+
+    // Objects named with the subtree root as a prefix, like cpu0_dimm
+    // for cpu0, sort between the root and its children, so find the
+    // children as the range of paths starting with "<root>/".
+    auto self = _refs.find(p);
+    auto bound = p + '/';
+    auto first = _refs.lower_bound(bound);
+    bound.back() = '/' + 1;
+    auto last = _refs.lower_bound(bound);
+
+    // InterfacesRemoved is built from the bindings, so emit the signals
+    // before the bindings go away; children before their parents.
+    for (auto it = std::make_reverse_iterator(last);
+         it != std::make_reverse_iterator(first); ++it)
+    {
+        emitObjectRemoved(it->first);
+        snapshotChanged(it->first, std::nullopt);
+        unindexObject(*it);
+    }
+    if (self != _refs.end())
+    {
+        emitObjectRemoved(self->first);
+        snapshotChanged(self->first, std::nullopt);
+        unindexObject(*self);
+        _refs.erase(self);
+    }
+    _refs.erase(first, last);
+
+    SerialOps::remove(p);
+    publishSnapshot();
+}
+
+std::shared_ptr<const Snapshot> Manager::snapshot() const noexcept
+{
+    return _snapshots.current();
+}
+
+void Manager::snapshotChanged([[maybe_unused]] std::string_view path,
+                              [[maybe_unused]] std::optional<InterfaceId> id)
+{
+#ifdef SNAPSHOTS
+    auto it = _snapshotDirty.find(path);
+    if (it == _snapshotDirty.end())
+    {
+        it = _snapshotDirty.try_emplace(std::string(path)).first;
+    }
+    if (id && std::ranges::find(it->second, *id) == it->second.end())
+    {
+        it->second.push_back(*id);
+    }
+#endif
+}
+
+void Manager::publishSnapshot()
+{
+    // Readers see a transaction all at once, when it is committed.
+    if (_transaction.depth || _snapshotDirty.empty())
+    {
+        return;
+    }
+
+    auto previous = _snapshots.current();
+    auto generation = previous->version + 1;
+    const auto rootSize = std::strlen(_root);
+    for (const auto& [path, changed] : _snapshotDirty)
+    {
+        auto relPath = std::string_view(path).substr(rootSize);
+        const auto* before = previous->find(relPath);
+        auto refit = _refs.find(path);
+        if (refit == _refs.end())
+        {
+            if (before)
+            {
+                for (const auto& [interface, properties] : *before)
                 {
-                    ifaceIt = refIt->second.find(condition.interface);
+                    _changeLog.record(generation, relPath, interface);
                 }
+            }
+            _snapshots.remove(relPath);
+            if (_sharedView)
+            {
+                _sharedView->remove(path);
+            }
+            continue;
+        }
 
-                if ((refIt != _refs.end()) && (ifaceIt != refIt->second.end()))
-                {
-                    const auto& maker = _makers.find(condition.interface);
-                    if (maker != _makers.end())
-                    {
-                        auto& getProperty =
-                            std::get<GetPropertyValueType>(maker->second);
+        // Only the interfaces that may have changed are read again; the
+        // others, and any that read back equal, are shared with the
+        // previous version.
+        static const SnapshotObject none;
+        const auto& last = before ? *before : none;
+        SnapshotObject object;
+        object.reserve(refit->second.size());
+        bool modified = !before;
+        for (auto& [id, holder] : refit->second)
+        {
+            const auto& interface = _makers[id].first;
+            auto old = last.find(interface);
+            if (old != last.end() &&
+                std::ranges::find(changed, id) == changed.end())
+            {
+                object.emplace(interface, old->second);
+                continue;
+            }
 
-                        condition.actualValue =
-                            getProperty(condition.property, ifaceIt->second);
-                    }
-                }
+            auto& get = std::get<GetPropertiesType>(_makers[id].second);
+            auto properties = get(holder);
+            if (old != last.end() && *old->second == properties)
+            {
+                object.emplace(interface, old->second);
+                continue;
+            }
+            _changeLog.record(generation, relPath, interface);
+            object.emplace(interface, std::make_shared<const Interface>(
+                                          std::move(properties)));
+            modified = true;
+        }
+
+        // Log the interfaces that were removed.
+        for (const auto& [interface, properties] : last)
+        {
+            if (!object.contains(interface))
+            {
+                _changeLog.record(generation, relPath, interface);
+                modified = true;
+            }
+        }
+        if (!modified)
+        {
+            continue;
+        }
+        if (_sharedView)
+        {
+            updateSharedView(path, object);
+        }
+        _snapshots.stage(relPath, std::move(object));
+    }
+    _snapshotDirty.clear();
+    _snapshots.publish();
+
+    if (_sharedView)
+    {
+        _sharedView->publish(_snapshots.current()->version);
+    }
+}
+
+void Manager::updateSharedView(std::string_view path,
+                               const SnapshotObject& object)
+{
+    static_assert(std::is_same_v<view::Value, InterfaceVariantType>);
+
+    view::Encoder encoder;
+    encoder.object(path, object.size());
+    for (const auto& [interface, properties] : object)
+    {
+        encoder.interface(interface, properties->size());
+        for (const auto& [name, value] : *properties)
+        {
+            encoder.property(name, value);
+        }
+    }
+    _sharedView->update(path, encoder.image());
+}
+
+Manager::Changes
+    Manager::changesSince([[maybe_unused]] std::uint64_t stream,
+                          [[maybe_unused]] std::uint64_t generation) const
+{
+    auto snapshot = _snapshots.current();
+    Changes changes;
+    changes.stream = _changeLog.stream();
+    changes.generation = snapshot->version;
+
+    // Changes are logged as snapshots are published, so without them
+    // clients always resync.
+    std::optional<ChangeLog::Changes> changed;
+#ifdef SNAPSHOTS
+    if (stream == changes.stream && generation <= changes.generation)
+    {
+        changed = _changeLog.since(generation);
+    }
+#endif
+    if (!changed)
+    {
+        changes.resync = true;
+        return changes;
+    }
+
+    for (const auto& [path, interfaces] : *changed)
+    {
+        static const SnapshotObject none;
+        const auto* object = snapshot->find(path);
+        const auto& current = object ? *object : none;
+        sdbusplus::object_path objectPath{path};
+        for (const auto& interface : interfaces)
+        {
+            if (auto it = current.find(interface); it != current.end())
+            {
+                changes.update[objectPath].emplace(interface, *it->second);
+            }
+            else
+            {
+                changes.remove[objectPath].push_back(interface);
+            }
+        }
+    }
+    return changes;
+}
+
+std::map<std::string, std::uint64_t> Manager::statistics() const
+{
+    return {
+        {"PropertiesReceived", _statistics.propertiesReceived},
+        {"PropertiesUnchanged", _statistics.propertiesUnchanged},
+        {"SerializationsSkipped", _statistics.serializationsSkipped},
+        {"NotifyRejected", _statistics.notifyRejected},
+        {"NotifySuperseded", _statistics.notifySuperseded},
+        {"NotifyFailed", _statistics.notifyFailed},
+        {"EventsInFlight", _eventsInFlight},
+        {"ActionsRun", _statistics.actionsRun},
+        {"ActionSlicesYielded", _statistics.actionSlicesYielded},
+        {"LoopIterations", _statistics.loopIterations},
+        {"LoopDispatchMicroseconds", _statistics.loopDispatchUs},
+        {"LoopDispatchMaxMicroseconds", _statistics.loopDispatchMaxUs},
+    };
+}
+
+void Manager::applyDelta(
+    std::map<sdbusplus::object_path, Object>&& update,
+    const std::map<sdbusplus::object_path, std::vector<std::string>>& remove)
+{
+    drainQueue();
+
+    for (const auto& [path, interfaces] : remove)
+    {
+        removeInterfaces(path, interfaces);
+    }
+
+    updateObjects(std::move(update));
+}
+
+Manager::ObjectPage
+    Manager::getObjects(std::string_view prefix,
+                        const std::vector<std::string>& interfaces,
+                        std::string_view cursor, std::size_t count)
+{
+    if (!count)
+    {
+        throw sdbusplus::xyz::openbmc_project::Common::Error::
+            InvalidArgument();
+    }
+
+    std::vector<InterfaceId> ids;
+    for (const auto& interface : interfaces)
+    {
+        if (auto id = interfaceId(interface))
+        {
+            ids.push_back(*id);
+        }
+    }
+    if (!interfaces.empty() && ids.empty())
+    {
+        return {};
+    }
+
+    std::string p{_root};
+    p.append(prefix);
+    while (p.ends_with('/'))
+    {
+        p.pop_back();
+    }
+
+    // Path elements only use [A-Za-z0-9_], which all sort after '/', so
+    // the subtree is exactly the paths from "<root>" up to "<root>0".
+    auto it = _refs.lower_bound(p);
+    p.push_back('/' + 1);
+    auto last = _refs.lower_bound(p);
+
+    if (!cursor.empty())
+    {
+        RootedPath after{_root, cursor};
+        if (last != _refs.end() &&
+            PathCompare::compare(last->first, after) <= 0)
+        {
+            it = last;
+        }
+        else if (it != last && PathCompare::compare(it->first, after) <= 0)
+        {
+            it = _refs.upper_bound(after);
+        }
+    }
+
+    // With an interface filter, few of the objects looked at may match,
+    // so stop after a bounded number of them even if the page is short.
+    ObjectPage page;
+    auto& [objects, next] = page;
+    const auto rootSize = std::strlen(_root);
+    const auto limit = std::max(count, pageScanLimit);
+    for (std::size_t examined = 0;
+         it != last && objects.size() < count && examined < limit;
+         ++it, ++examined)
+    {
+        Object object;
+        for (auto& [id, holder] : it->second)
+        {
+            if (!ids.empty() && std::ranges::find(ids, id) == ids.end())
+            {
+                continue;
+            }
+            auto& get = std::get<GetPropertiesType>(_makers[id].second);
+            object.emplace(_makers[id].first, get(holder));
+        }
+        if (!object.empty())
+        {
+            objects.emplace(it->first.substr(rootSize), std::move(object));
+        }
+    }
+
+    // Resume after the last object looked at, whether or not it matched.
+    if (it != last)
+    {
+        next = std::prev(it)->first.substr(rootSize);
+    }
+    return page;
+}
+
+Manager::QueryPage Manager::query(
+    std::string_view interface,
+    const std::map<std::string, InterfaceVariantType>& properties,
+    std::string_view cursor, std::size_t count)
+{
+    if (!count)
+    {
+        throw sdbusplus::xyz::openbmc_project::Common::Error::
+            InvalidArgument();
+    }
+
+    auto id = interfaceId(interface);
+    auto index = id ? _indexes.find(*id) : _indexes.end();
+    if (index == _indexes.end())
+    {
+        throw sdbusplus::xyz::openbmc_project::Common::Error::
+            InvalidArgument();
+    }
+
+    // Catch up with properties event actions may have set.
+    for (const auto& path : _reindex)
+    {
+        auto refit = _refs.find(RootedPath{_root, path});
+        if (refit == _refs.end())
+        {
+            continue;
+        }
+        for (auto& [ifaceId, holder] : refit->second)
+        {
+            if (auto it = _indexes.find(ifaceId); it != _indexes.end())
+            {
+                indexInterface(it->second, path, ifaceId, holder);
             }
+        }
+    }
+    _reindex.clear();
+
+    // Walk the smallest match, checking the others for each object.
+    std::vector<const InterfaceIndex::Paths*> matches{
+        &index->second.paths()};
+    for (const auto& [name, value] : properties)
+    {
+        auto paths = index->second.find(name, value);
+        if (!paths)
+        {
+            throw sdbusplus::xyz::openbmc_project::Common::Error::
+                InvalidArgument();
+        }
+        matches.push_back(paths);
+    }
+    std::ranges::sort(matches, {},
+                      [](const auto* paths) { return paths->size(); });
+
+    // Like GetObjects, bound the paths looked at for one page, since the
+    // other matches may exclude most of the smallest one.
+    QueryPage page;
+    auto& [result, next] = page;
+    const auto& walk = *matches.front();
+    auto it = cursor.empty() ? walk.begin() : walk.upper_bound(cursor);
+    const auto limit = std::max(count, pageScanLimit);
+    for (std::size_t examined = 0;
+         it != walk.end() && result.size() < count && examined < limit;
+         ++it, ++examined)
+    {
+        if (std::ranges::all_of(matches | std::views::drop(1),
+                                [it](const auto* paths) {
+                                    return paths->contains(*it);
+                                }))
+        {
+            result.emplace_back(*it);
+        }
+    }
+
+    // Resume after the last path looked at, whether or not it matched.
+    if (it != walk.end())
+    {
+        next = *std::prev(it);
+    }
+    return page;
+}
+
+void Manager::indexInterface(InterfaceIndex& index, std::string_view path,
+                             InterfaceId id, InterfaceHolder& holder)
+{
+    auto& get = std::get<GetPropertiesType>(_makers[id].second);
+    auto properties = get(holder);
+    index.add(path);
+    for (std::size_t i = 0; i < index.properties(); ++i)
+    {
+        if (auto it = properties.find(index.property(i));
+            it != properties.end())
+        {
+            index.set(i, path, it->second);
+        }
+    }
+}
+
+void Manager::unindexObject(const ObjectReferences::value_type& object)
+{
+    if (_indexes.empty())
+    {
+        return;
+    }
 
-            // Check if a property value in a condition matches an
-            // actual property value just saved.  If one did, now the
-            // associations file is valid so create its associations.
-            if (_associations.conditionMatch())
+    auto path = std::string_view(object.first).substr(std::strlen(_root));
+    for (const auto& [id, holder] : object.second)
+    {
+        if (auto it = _indexes.find(id); it != _indexes.end())
+        {
+            it->second.remove(path);
+        }
+    }
+}
+
+void Manager::removeInterfaces(const std::string& path,
+                               const std::vector<std::string>& interfaces)
+{
+    auto refit = _refs.find(RootedPath{_root, path});
+    if (refit == _refs.end())
+    {
+        return;
+    }
+
+    const auto& absPath = refit->first;
+    auto& refaces = refit->second;
+    auto pending = _pendingSignals.find(absPath);
+    auto objectAnnounced =
+        pending == _pendingSignals.end() || !pending->second.objectAdded;
+
+    std::vector<InterfaceId> ids;
+    std::vector<std::string> removed;
+    for (const auto& interface : interfaces)
+    {
+        auto id = interfaceId(interface);
+        if (!id || findInterface(refaces, *id) == refaces.end() ||
+            std::ranges::find(ids, *id) != ids.end())
+        {
+            continue;
+        }
+        ids.push_back(*id);
+
+        // Held signals for the interface are moot now, and if it was
+        // never announced there is nothing to tell listeners.
+        auto announced = objectAnnounced;
+        if (pending != _pendingSignals.end())
+        {
+            auto& signals = pending->second;
+            if (auto added = std::ranges::find(signals.added, *id);
+                added != signals.added.end())
             {
-                std::for_each(
-                    _refs.begin(), _refs.end(), [this](const auto& ref) {
-                        _associations.createAssociations(
-                            ref.first, _status != ManagerStatus::RUNNING);
-                    });
+                signals.added.erase(added);
+                announced = false;
             }
+            std::erase_if(signals.changed, [id](const auto& changed) {
+                return changed.first == *id;
+            });
+        }
+        if (announced)
+        {
+            removed.push_back(interface);
+        }
+    }
+
+    if (!removed.empty())
+    {
+        _bus.emit_interfaces_removed(absPath.c_str(), removed);
+    }
+
+    for (auto id : ids)
+    {
+        SerialOps::remove(absPath, _makers[id].first);
+        refaces.erase(findInterface(refaces, id));
+        if (auto index = _indexes.find(id); index != _indexes.end())
+        {
+            index->second.remove(path);
         }
+    }
+    if (!ids.empty())
+    {
+        snapshotChanged(absPath, std::nullopt);
+    }
+
+    if (refaces.empty())
+    {
+        if (pending != _pendingSignals.end())
+        {
+            _pendingSignals.erase(pending);
+        }
+        _refs.erase(refit);
+    }
+}
+
+void Manager::emitObjectRemoved(const std::string& path)
+{
+    // Nothing needs to be removed if the object was never announced.
+    auto pending = _pendingSignals.find(path);
+    auto announced =
+        pending == _pendingSignals.end() || !pending->second.objectAdded;
+    if (pending != _pendingSignals.end())
+    {
+        _pendingSignals.erase(pending);
+    }
+    if (announced)
+    {
+        _bus.emit_object_removed(path.c_str());
+    }
+}
+
+#ifdef COMPACT_STORE
+InterfaceVariantType Manager::getPropertyValue(const char* path,
+                                               const char* interface,
+                                               const char* property)
+{
+    auto& holder = getInterfaceHolder(path, interface);
+    auto& values = _compactInfo[*interfaceId(interface)]->values(holder);
+    return values.getPropertyByName(property);
+}
+
+void Manager::setPropertyValue(const char* path, const char* interface,
+                               const char* property,
+                               InterfaceVariantType value)
+{
+    auto& holder = getInterfaceHolder(path, interface);
+    auto& values = _compactInfo[*interfaceId(interface)]->values(holder);
+    if (values.getPropertyByName(property) == value)
+    {
+        return;
+    }
+    if (!values.setPropertyByName(property, std::move(value)))
+    {
+        throw std::runtime_error(std::string{"invalid value for "} +
+                                 interface + "." + property);
+    }
+
+    auto absPath = std::string(_root) + path;
+    auto r = sd_bus_emit_properties_changed(_bus.get(), absPath.c_str(),
+                                            interface, property, nullptr);
+    if (r < 0)
+    {
+        lg2::error("Failed to emit PropertiesChanged for {INTERFACE} on "
+                   "{PATH}: {ERROR}",
+                   "INTERFACE", interface, "PATH", absPath, "ERROR",
+                   strerror(-r));
+    }
+    snapshotChanged(absPath, interfaceId(interface));
+    if (!_indexes.empty())
+    {
+        _reindex.emplace(path);
+    }
+}
+#endif
+
+void Manager::propertiesWritten(const std::string& path, InterfaceId id)
+{
+    auto refit = _refs.find(path);
+    if (refit == _refs.end())
+    {
+        return;
+    }
+    auto ifaceit = findInterface(refit->second, id);
+    if (ifaceit == refit->second.end())
+    {
+        return;
+    }
+
+    snapshotChanged(path, id);
+    if (!_indexes.empty())
+    {
+        _reindex.emplace(path.substr(std::strlen(_root)));
+    }
+
+    if (_transaction.depth)
+    {
+        auto& unsaved = _transaction.unsaved[path];
+        if (std::ranges::find(unsaved, id) == unsaved.end())
+        {
+            unsaved.push_back(id);
+        }
+    }
+    else
+    {
+        auto& serialize =
+            std::get<SerializeInterfaceType<SerialOps>>(_makers[id].second);
+        serialize(path, _makers[id].first, ifaceit->second);
+    }
+}
+
+#ifndef COMPACT_STORE
+int Manager::noteWrite(sd_bus_message* m, void* data,
+                       sd_bus_error* /* error */) noexcept
+{
+    auto& mgr = *static_cast<Manager*>(data);
+    if (!sd_bus_message_is_method_call(m, "org.freedesktop.DBus.Properties",
+                                       "Set"))
+    {
+        return 0;
+    }
+
+    std::string_view path{sd_bus_message_get_path(m)};
+    const char* interface = nullptr;
+    auto r = sd_bus_message_read(m, "s", &interface);
+    sd_bus_message_rewind(m, 1);
+    if (r < 0)
+    {
+        return 0;
+    }
+
+    try
+    {
+        auto id = interfaceId(interface);
+        if (!id || !mgr._refs.contains(path))
+        {
+            return 0;
+        }
+        auto it = mgr._written.find(path);
+        if (it == mgr._written.end())
+        {
+            it = mgr._written.try_emplace(std::string(path)).first;
+        }
+        if (std::ranges::find(it->second, *id) == it->second.end())
+        {
+            it->second.push_back(*id);
+        }
+        mgr._writtenSource.set_enabled(sdeventplus::source::Enabled::On);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to note a Set request: {ERROR}", "ERROR", e);
+    }
+
+    // Let the bindings handle the request.
+    return 0;
+}
+#endif
+
+void Manager::createObjects(
+    const std::map<sdbusplus::object_path, Object>& objs)
+{
+    updateObjects(objs);
+}
+
+InterfaceHolder& Manager::getInterfaceHolder(const char* path,
+                                             const char* interface)
+{
+    return const_cast<InterfaceHolder&>(
+        const_cast<const Manager*>(this)->getInterfaceHolder(path, interface));
+}
+
+const InterfaceHolder& Manager::getInterfaceHolder(const char* path,
+                                                   const char* interface) const
+{
+    auto oit = _refs.find(RootedPath{_root, path});
+    if (oit == _refs.end())
+        throw std::runtime_error(std::string{_root} + path + " was not found");
+
+    auto& obj = oit->second;
+    auto id = interfaceId(interface);
+    auto iit = id ? findInterface(obj, *id) : obj.end();
+    if (iit == obj.end())
+        throw std::runtime_error("interface was not found");
+
+    return iit->second;
+}
+
+std::optional<Manager::InterfaceId>
+    Manager::interfaceId(std::string_view interface)
+{
+    auto it = std::lower_bound(_makers.cbegin(), _makers.cend(), interface,
+                               compareFirst(std::less<>()));
+    if (it == _makers.cend() || it->first != interface)
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<InterfaceId>(it - _makers.cbegin());
+}
+
+void Manager::restore()
+{
+    // The directory scan is transient, so allocate it from one arena
+    // instead of node by node from the heap.  Objects are restored
+    // straight from the scan, one at a time, without building a map of
+    // them all first.
+    std::pmr::monotonic_buffer_resource arena;
+    auto persisted =
+        detail::scanStorage(PIM_PERSIST_PATH, INVENTORY_ROOT, &arena);
+    if (persisted.empty())
+    {
+        return;
+    }
+
+    auto restoreFromCache = true;
+    for (const auto& [path, interfaces] : persisted)
+    {
+        Object object;
+        object.reserve(interfaces.size());
+        for (const auto& interface : interfaces)
+        {
+            object.emplace(std::string_view{interface}, Interface{});
+        }
+        updateObject(path, std::move(object), restoreFromCache);
+    }
+    finishUpdate();
+
+#ifdef CREATE_ASSOCIATIONS
+    // There may be conditional associations waiting to be loaded
+    // based on certain path/interface/property values.
+    if (_associations.pendingCondition())
+    {
+        checkAssociationConditions();
+    }
 #endif
+}
+
+#ifdef CREATE_ASSOCIATIONS
+void Manager::checkAssociationConditions()
+{
+    // _refs contains all objects with their property values, so check
+    // which property values the conditions need and set them in the
+    // condition structure entries, using the actualValue field.  Then
+    // the associations manager can check if the conditions are met.
+    auto& conditions = _associations.getConditions();
+    for (auto& condition : conditions)
+    {
+        auto id = interfaceId(condition.interface);
+        auto refIt = _refs.find(RootedPath{_root, condition.path});
+        if (!id || refIt == _refs.end())
+        {
+            continue;
+        }
+
+        auto ifaceIt = findInterface(refIt->second, *id);
+        if (ifaceIt != refIt->second.end())
+        {
+            auto& getProperty =
+                std::get<GetPropertyValueType>(_makers[*id].second);
+
+            condition.actualValue =
+                getProperty(condition.property, ifaceIt->second);
+        }
+    }
+
+    // Check if a property value in a condition matches an
+    // actual property value just saved.  If one did, now the
+    // associations file is valid so create its associations.
+    if (_associations.conditionMatch())
+    {
+        std::for_each(_refs.begin(), _refs.end(), [this](const auto& ref) {
+            _associations.createAssociations(
+                ref.first, _status != ManagerStatus::RUNNING);
+        });
+    }
+}
+#endif
+
+void Manager::beginTransaction(const std::string& client)
+{
+    if (_transaction.depth && _transaction.owner != client)
+    {
+        // Its updates would be committed with the owner's.
+        throw sdbusplus::xyz::openbmc_project::Common::Error::Unavailable();
+    }
+
+    if (_transaction.depth++ == 0)
+    {
+        _transaction.owner = client;
+        _transactionTimer.restartOnce(
+            std::chrono::seconds(TRANSACTION_TIMEOUT_S));
+
+        // Unique names start with a colon; peers are reported by the
+        // peer server.
+        if (client.starts_with(':'))
+        {
+            try
+            {
+                _transaction.ownerWatch.emplace(
+                    _bus,
+                    sdbusplus::bus::match::rules::nameOwnerChanged(client)
+                        .c_str(),
+                    transactionOwnerChanged, this);
+            }
+            catch (const std::exception& e)
+            {
+                lg2::error("Failed to watch {CLIENT}: {ERROR}", "CLIENT",
+                           client, "ERROR", e);
+            }
+        }
+    }
+}
+
+void Manager::commitTransaction(const std::string& client)
+{
+    if (_transaction.depth == 0)
+    {
+        throw std::runtime_error("No transaction to commit");
+    }
+    if (_transaction.owner != client)
+    {
+        throw sdbusplus::xyz::openbmc_project::Common::Error::NotAllowed();
+    }
+
+    if (--_transaction.depth == 0)
+    {
+        drainQueue();
+        finishTransaction();
+    }
+}
+
+void Manager::clientGone(const std::string& client)
+{
+    if (_transaction.depth == 0 || _transaction.owner != client)
+    {
+        return;
+    }
+
+    lg2::warning("Committing the transaction of {CLIENT}, which went away",
+                 "CLIENT", client);
+    drainQueue();
+    finishTransaction();
+}
+
+int Manager::transactionOwnerChanged(sd_bus_message* m, void* data,
+                                     sd_bus_error* /* error */) noexcept
+{
+    auto& mgr = *static_cast<Manager*>(data);
+    const char* name = nullptr;
+    const char* oldOwner = nullptr;
+    const char* newOwner = nullptr;
+    if (sd_bus_message_read(m, "sss", &name, &oldOwner, &newOwner) < 0 ||
+        *newOwner)
+    {
+        return 0;
+    }
+
+    try
+    {
+        mgr.clientGone(name);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to commit: {ERROR}", "ERROR", e);
     }
+    return 0;
 }
 
+void Manager::finishTransaction()
+{
+    _transaction.depth = 0;
+    _transaction.owner.clear();
+    _transaction.ownerWatch.reset();
+    _transactionTimer.setEnabled(false);
+    auto unsaved = std::move(_transaction.unsaved);
+    auto created = std::move(_transaction.created);
+    _transaction.unsaved.clear();
+    _transaction.created.clear();
+
+    // Objects and interfaces may have been destroyed since they were
+    // updated, so look them up again.
+    for (const auto& [path, ids] : unsaved)
+    {
+        auto refit = _refs.find(path);
+        if (refit == _refs.end())
+        {
+            continue;
+        }
+
+        for (auto id : ids)
+        {
+            auto ifaceit = findInterface(refit->second, id);
+            if (ifaceit == refit->second.end())
+            {
+                continue;
+            }
+
+            auto& serialize =
+                std::get<SerializeInterfaceType<SerialOps>>(_makers[id].second);
+            serialize(path, _makers[id].first, ifaceit->second);
+        }
+    }
+
+#ifdef CREATE_ASSOCIATIONS
+    if (_associations.pendingCondition())
+    {
+        checkAssociationConditions();
+    }
+    else
+    {
+        for (const auto& path : created)
+        {
+            if (_refs.contains(path))
+            {
+                _associations.createAssociations(
+                    path, _status != ManagerStatus::RUNNING);
+            }
+        }
+    }
+#endif
+
+    flushSignals();
+    publishSnapshot();
+}
+
+#ifdef DYNAMIC_INTERFACES
+namespace
+{
+/** @brief The interfaces described at startup. */
+const compact::Registry& interfaceRegistry()
+{
+    static const auto registry = []() {
+        try
+        {
+            return compact::Registry::load(INTERFACES_FILE_PATH);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to load interfaces from {FILE}: {ERROR}",
+                       "FILE", INTERFACES_FILE_PATH, "ERROR", e);
+            return compact::Registry{};
+        }
+    }();
+    return registry;
+}
+} // namespace
+
+const Manager::Makers Manager::_makers = []() {
+    Makers makers;
+    for (const auto* info : interfaceRegistry().interfaces())
+    {
+        makers.emplace_back(
+            info->name,
+            InterfaceOps{
+                nullptr, AssignInterface<compact::Dynamic>::op,
+                +[](const std::string& path, const std::string& iface,
+                    const InterfaceHolder& holder) {
+                    // As with bindings without properties, interfaces
+                    // without properties persist as an empty file.
+                    const auto& object = holder.get<compact::Dynamic>();
+                    if (object.info().properties.empty())
+                    {
+                        SerialOps::serialize(path, iface);
+                        return;
+                    }
+                    SerialOps::serialize(path, iface, object);
+                },
+                +[](const std::string& path, const std::string& iface,
+                    InterfaceHolder& holder) {
+                    auto& object = holder.get<compact::Dynamic>();
+                    if (object.info().properties.empty())
+                    {
+                        SerialOps::deserialize(path, iface);
+                        return;
+                    }
+                    SerialOps::deserialize(path, iface, object);
+                },
+                +[](InterfaceHolder& holder) {
+                    return holder.get<compact::Dynamic>().properties();
+                }
+#ifdef CREATE_ASSOCIATIONS
+                ,
+                GetPropertyValue<compact::Dynamic>::op
+#endif
+            });
+    }
+    return makers;
+}();
+
+const Manager::CompactInfo Manager::_compactInfo{
+    interfaceRegistry().interfaces().begin(),
+    interfaceRegistry().interfaces().end()};
+#endif
+
 } // namespace manager
 } // namespace inventory
 } // namespace phosphor
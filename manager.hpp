@@ -1,21 +1,44 @@
 #pragma once
 
+#include "changelog.hpp"
+#include "compact.hpp"
 #include "events.hpp"
+#include "extensions.hpp"
 #include "functor.hpp"
+#include "index.hpp"
 #include "interface_ops.hpp"
+#include "peer.hpp"
 #include "serialize.hpp"
+#include "shared_view.hpp"
+#include "snapshot.hpp"
 #include "types.hpp"
 #ifdef CREATE_ASSOCIATIONS
 #include "association_manager.hpp"
 #endif
+#ifdef DYNAMIC_INTERFACES
+#include "dynamic.hpp"
+#endif
 
+#include <sdbusplus/bus/match.hpp>
 #include <sdbusplus/server.hpp>
+#include <sdeventplus/clock.hpp>
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+#include <sdeventplus/source/io.hpp>
+#include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/Inventory/Manager/server.hpp>
 
-#include <any>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace phosphor
@@ -45,7 +68,7 @@ class Manager final : public ServerObject<ManagerIface>
     Manager& operator=(const Manager&) = delete;
     Manager(Manager&&) = delete;
     Manager& operator=(Manager&&) = delete;
-    ~Manager() = default;
+    ~Manager();
 
     /** @brief Construct an inventory manager.
      *
@@ -64,11 +87,21 @@ class Manager final : public ServerObject<ManagerIface>
      */
     void run(const char*);
 
-    /** @brief Provided for testing only. */
+    /** @brief Provided for testing only.
+     *
+     *  Safe to call from any thread.  Wakes the event loop, which stops
+     *  once the events in flight finish.
+     */
     void shutdown() noexcept;
 
     /** @brief sd_bus Notify method implementation callback. */
-    void notify(std::map<sdbusplus::object_path, Object> objs) override;
+    void notify(NotifyObjects objs) override;
+
+    /** @brief Apply queued Notify updates.
+     *
+     *  @param[in] limit - The most objects to apply.
+     */
+    void drainQueue(std::size_t limit = SIZE_MAX);
 
     /** @brief Event processing entry point. */
     void handleEvent(sdbusplus::message_t&, const Event& event,
@@ -77,6 +110,146 @@ class Manager final : public ServerObject<ManagerIface>
     /** @brief Drop one or more objects from DBus. */
     void destroyObjects(const std::vector<const char*>& paths);
 
+    /** @brief Drop an object, all objects below it and their persisted
+     *      state from DBus.
+     */
+    void destroySubtree(const char* path);
+
+    /** @brief Start deferring persistence, signals and associations.
+     *
+     *  Transactions nest, and the deferred work is done when the
+     *  outermost one is committed, or after TRANSACTION_TIMEOUT_S
+     *  seconds if it is abandoned.  One client at a time may have a
+     *  transaction open, and only it may commit it.
+     *
+     *  @param[in] client - The client, by its unique bus name, or for
+     *      peer connections, the name the connection is known by.
+     */
+    void beginTransaction(const std::string& client);
+
+    /** @brief End a transaction started by beginTransaction().
+     *
+     *  @param[in] client - The client that started it.
+     */
+    void commitTransaction(const std::string& client);
+
+    /** @brief Commit the open transaction of a client that went away.
+     *
+     *  Bus clients are watched for by the manager itself.
+     *
+     *  @param[in] client - The client.
+     */
+    void clientGone(const std::string& client);
+
+    /** @brief The latest published inventory snapshot.
+     *
+     *  Safe to call from any thread.  A snapshot is published after each
+     *  update, removal and event action, and when a transaction is
+     *  committed.
+     */
+    std::shared_ptr<const Snapshot> snapshot() const noexcept;
+
+    /** @brief The changes since a generation, as a delta. */
+    struct Changes
+    {
+        /** @brief The change log's stream ID. */
+        std::uint64_t stream = 0;
+
+        /** @brief The generation the delta brings the caller up to. */
+        std::uint64_t generation = 0;
+
+        /** @brief Set if the changes are not known, and the caller has
+         *      to fetch the whole inventory.
+         */
+        bool resync = false;
+
+        /** @brief Interfaces added or changed, with their properties. */
+        std::map<sdbusplus::object_path, Object> update;
+
+        /** @brief Interfaces removed, by object. */
+        std::map<sdbusplus::object_path, std::vector<std::string>> remove;
+    };
+
+    /** @brief The changes made since a generation.
+     *
+     *  Generations are snapshot versions.  Only the latest state of each
+     *  changed interface is returned, so the delta can be applied as
+     *  with applyDelta().
+     *
+     *  @param[in] stream - The stream ID of the generation.
+     *  @param[in] generation - The generation the caller has.
+     */
+    Changes changesSince(std::uint64_t stream, std::uint64_t generation) const;
+
+    /** @brief Counters describing the work done so far, by name. */
+    std::map<std::string, std::uint64_t> statistics() const;
+
+    /** @brief Apply a change set to the inventory.
+     *
+     *  Interfaces are removed before the updates are applied, so an
+     *  interface in both is recreated with only the new properties.
+     *
+     *  @param[in] update - Objects to add or update, as with Notify.
+     *  @param[in] remove - Interfaces to remove, by object.
+     */
+    void applyDelta(
+        std::map<sdbusplus::object_path, Object>&& update,
+        const std::map<sdbusplus::object_path, std::vector<std::string>>&
+            remove);
+
+    /** @brief A page of objects and the cursor for the next page. */
+    using ObjectPage =
+        std::pair<std::map<sdbusplus::object_path, Object>, std::string>;
+
+    /** @brief Enumerate a subtree of the inventory a page at a time.
+     *
+     *  Objects are walked in path order.  The cursor returned with a
+     *  page is passed to get the next one, and is empty once the walk is
+     *  done.  Objects added or removed between pages are seen or not
+     *  depending on where they sort relative to the cursor.
+     *
+     *  @param[in] prefix - The subtree root, relative to the inventory
+     *      root.  Empty enumerates the whole inventory.
+     *  @param[in] interfaces - The interfaces to return.  Objects with
+     *      none of them are skipped.  Empty returns every interface.
+     *  @param[in] cursor - Where the last page ended, or empty to start.
+     *  @param[in] count - The most objects to return.  A page may be
+     *      short, or empty, before the walk is done if few objects have
+     *      the interfaces asked for.
+     *
+     *  @returns The objects, by path relative to the inventory root, and
+     *      the cursor.
+     */
+    ObjectPage getObjects(std::string_view prefix,
+                          const std::vector<std::string>& interfaces,
+                          std::string_view cursor, std::size_t count);
+
+    /** @brief A page of object paths and the cursor for the next page. */
+    using QueryPage =
+        std::pair<std::vector<sdbusplus::object_path>, std::string>;
+
+    /** @brief Find the objects implementing an interface with the given
+     *      property values, a page at a time.
+     *
+     *  The interface and properties must be indexed.  Matches are
+     *  returned in path order, and the cursor returned with a page is
+     *  passed to get the next one.
+     *
+     *  @param[in] interface - The interface.
+     *  @param[in] properties - The property values to match.  Empty
+     *      matches every object implementing the interface.
+     *  @param[in] cursor - Where the last page ended, or empty to start.
+     *  @param[in] count - The most paths to return.  A page may be short,
+     *      or empty, before the query is done if few objects match.
+     *
+     *  @returns The object paths, relative to the inventory root, and
+     *      the cursor, which is empty once the query is done.
+     */
+    QueryPage
+        query(std::string_view interface,
+              const std::map<std::string, InterfaceVariantType>& properties,
+              std::string_view cursor, std::size_t count);
+
     /** @brief Add objects to DBus. */
     void createObjects(const std::map<sdbusplus::object_path, Object>& objs);
 
@@ -84,6 +257,13 @@ class Manager final : public ServerObject<ManagerIface>
     void updateObjects(const std::map<sdbusplus::object_path, Object>& objs,
                        bool restoreFromCache = false);
 
+    /** @brief Add or update objects on DBus.
+     *
+     *  Property values are moved from objs into the server bindings.
+     */
+    void updateObjects(std::map<sdbusplus::object_path, Object>&& objs,
+                       bool restoreFromCache = false);
+
     /** @brief Restore persistent inventory items */
     void restore();
 
@@ -110,29 +290,102 @@ class Manager final : public ServerObject<ManagerIface>
                                 U&& member, Args&&... args)
     {
         auto& iface = getInterface<T>(path, interface);
+        // The method may set properties.
+        snapshotChanged(std::string(_root) + path, interfaceId(interface));
+        if (!_indexes.empty())
+        {
+            _reindex.emplace(path);
+        }
         return (iface.*member)(std::forward<Args>(args)...);
     }
 
+#ifdef COMPACT_STORE
+    /** @brief Read a property of an interface in the compact store.
+     *
+     *  @param[in] path - The object path, relative to the root.
+     *  @param[in] interface - The DBus interface.
+     *  @param[in] property - The property name.
+     */
+    InterfaceVariantType getPropertyValue(const char* path,
+                                          const char* interface,
+                                          const char* property);
+
+    /** @brief Set a property of an interface in the compact store.
+     *
+     *  As with a binding's setter, PropertiesChanged is sent right away
+     *  if the value changed.
+     *
+     *  @param[in] path - The object path, relative to the root.
+     *  @param[in] interface - The DBus interface.
+     *  @param[in] property - The property name.
+     *  @param[in] value - The new value.
+     */
+    void setPropertyValue(const char* path, const char* interface,
+                          const char* property, InterfaceVariantType value);
+#endif
+
     using SigArgs = std::vector<std::unique_ptr<
         std::tuple<Manager*, const DbusSignal*, const EventInfo*>>>;
     using SigArg = SigArgs::value_type::element_type;
 
   private:
-    using InterfaceComposite = std::map<std::string, std::any>;
-    using ObjectReferences = std::map<std::string, InterfaceComposite>;
+    /** @brief The index pimgen assigned an interface in _makers. */
+    using InterfaceId = std::uint16_t;
+
+    /** @brief Interface holders of an object, sorted by interface ID. */
+    using InterfaceComposite =
+        std::vector<std::pair<InterfaceId, InterfaceHolder>>;
+    /** @brief Objects by absolute path.  Each path belongs to one
+     *      object, so it isn't interned.
+     */
+    using ObjectReferences =
+        std::map<std::string, InterfaceComposite, PathCompare>;
     using Events = std::vector<EventInfo>;
 
     // The int instantiations are safe since the signature of these
     // functions don't change from one instantiation to the next.
-    using Makers =
-        std::map<std::string, std::tuple<MakeInterfaceType, AssignInterfaceType,
-                                         SerializeInterfaceType<SerialOps>,
-                                         DeserializeInterfaceType<SerialOps>
+    using InterfaceOps =
+        std::tuple<MakeInterfaceType, AssignInterfaceType,
+                   SerializeInterfaceType<SerialOps>,
+                   DeserializeInterfaceType<SerialOps>, GetPropertiesType
 #ifdef CREATE_ASSOCIATIONS
-                                         ,
-                                         GetPropertyValueType
+                   ,
+                   GetPropertyValueType
+#endif
+                   >;
+
+    /** @brief Interface binding ops, sorted by interface name.
+     *
+     *  pimgen emits the entries in name order, so the position of an
+     *  entry is also the ID of its interface and interface IDs sort the
+     *  same way interface names do.
+     *
+     *  With dynamic interfaces the entries are built at startup from the
+     *  interface descriptions, also in name order.  Every interface then
+     *  shares the same ops, and has no make op, since a
+     *  compact::Dynamic is made from its description instead.
+     */
+    using Makers = std::vector<std::pair<std::string, InterfaceOps>>;
+
+    /** @brief The interfaces to index, with their properties to index
+     *      by value.
+     */
+    using IndexConfig =
+        std::vector<std::pair<const char*, std::vector<std::string>>>;
+
+#ifdef COMPACT_STORE
+    /** @brief The compact store interfaces, by interface ID. */
+    using CompactInfo = std::vector<const compact::InterfaceInfo*>;
 #endif
-                                         >>;
+
+    /** @brief Look up the ID pimgen assigned to an interface.
+     *
+     *  @param[in] interface - The DBus interface name.
+     *
+     *  @returns The interface ID, or nullopt if the interface is
+     *      not supported.
+     */
+    static std::optional<InterfaceId> interfaceId(std::string_view interface);
 
     /** @brief Provides weak references to interface holders.
      *
@@ -146,8 +399,8 @@ class Manager final : public ServerObject<ManagerIface>
      *
      *  @returns A weak reference to the holder instance.
      */
-    const std::any& getInterfaceHolder(const char*, const char*) const;
-    std::any& getInterfaceHolder(const char*, const char*);
+    const InterfaceHolder& getInterfaceHolder(const char*, const char*) const;
+    InterfaceHolder& getInterfaceHolder(const char*, const char*);
 
     /** @brief Provides weak references to interface holders.
      *
@@ -162,22 +415,195 @@ class Manager final : public ServerObject<ManagerIface>
     template <typename T>
     auto& getInterface(const char* path, const char* interface)
     {
-        auto& holder = getInterfaceHolder(path, interface);
-        return *std::any_cast<std::shared_ptr<T>&>(holder);
+        return getInterfaceHolder(path, interface).get<T>();
     }
     template <typename T>
     auto& getInterface(const char* path, const char* interface) const
     {
-        auto& holder = getInterfaceHolder(path, interface);
-        return *std::any_cast<T>(holder);
+        return getInterfaceHolder(path, interface).get<T>();
     }
 
-    /** @brief Add or update interfaces on DBus. */
-    void updateInterfaces(const sdbusplus::object_path& path,
-                          const Object& interfaces,
-                          ObjectReferences::iterator pos, bool emitSignals,
+    /** @brief Add or update an object on DBus.
+     *
+     *  Signals and the snapshot are left to the caller, which may update
+     *  several objects first.
+     *
+     *  @param[in] path - The object path, relative to the root.
+     *  @param[in] interfaces - The interfaces, whose property values are
+     *      moved into the bindings.
+     *  @param[in] restoreFromCache - Whether the object is being restored
+     *      from persistent storage.
+     */
+    void updateObject(std::string_view path, Object&& interfaces,
+                      bool restoreFromCache);
+
+    /** @brief Send or schedule the signals of an update, and publish the
+     *      updated inventory.
+     */
+    void finishUpdate();
+
+    /** @brief Add or update interfaces on DBus.
+     *
+     *  @param[in] newObject - Whether the object was just added, and is
+     *      announced with InterfacesAdded for the whole object.
+     */
+    void updateInterfaces(const std::string& path, Object&& interfaces,
+                          ObjectReferences::iterator pos, bool newObject,
                           bool restoreFromCache);
 
+    /** @brief Index an interface added or reloaded by an object.
+     *
+     *  @param[in] index - The interface index.
+     *  @param[in] path - The object path, relative to the root.
+     *  @param[in] id - The interface.
+     *  @param[in] holder - The interface binding.
+     */
+    void indexInterface(InterfaceIndex& index, std::string_view path,
+                        InterfaceId id, InterfaceHolder& holder);
+
+    /** @brief Drop an object being destroyed from the indexes.
+     *
+     *  @param[in] object - The object.
+     */
+    void unindexObject(const ObjectReferences::value_type& object);
+
+    /** @brief Signals held back for an object until the next flush. */
+    struct PendingSignals
+    {
+        /** @brief The object is new, so announce all of its interfaces. */
+        bool objectAdded = false;
+
+        /** @brief Interfaces added to an existing object. */
+        std::vector<InterfaceId> added;
+
+        /** @brief Changed properties of existing interfaces. */
+        std::vector<std::pair<InterfaceId, std::vector<std::string>>> changed;
+    };
+
+    /** @brief Remove interfaces from an object, and from persistent
+     *      storage.
+     *
+     *  Unknown objects and interfaces are ignored.  An object left
+     *  without interfaces is destroyed.
+     *
+     *  @param[in] path - The object path, relative to the root.
+     *  @param[in] interfaces - The interfaces to remove.
+     */
+    void removeInterfaces(const std::string& path,
+                          const std::vector<std::string>& interfaces);
+
+    /** @brief Do the work deferred by the open transaction. */
+    void finishTransaction();
+
+    /** @brief NameOwnerChanged callback for the owner of the open
+     *      transaction.
+     */
+    static int transactionOwnerChanged(sd_bus_message* m, void* data,
+                                       sd_bus_error* error) noexcept;
+
+#ifdef CREATE_ASSOCIATIONS
+    /** @brief Load conditional associations matched by any object and
+     *      create them for every object.
+     */
+    void checkAssociationConditions();
+#endif
+
+    /** @brief Send InterfacesRemoved for an object being destroyed.
+     *
+     *  Any signals held for the object are dropped, and nothing is sent
+     *  if the object itself was never announced.
+     *
+     *  @param[in] path - The absolute object path.
+     */
+    void emitObjectRemoved(const std::string& path);
+
+    /** @brief Emit the held ObjectManager and PropertiesChanged signals,
+     *      unless a transaction is open.
+     */
+    void flushSignals();
+
+    /** @brief Note an object changed since the last snapshot.
+     *
+     *  @param[in] path - The absolute object path.
+     *  @param[in] id - The interface whose properties may have changed,
+     *      or nullopt if only interfaces were removed.
+     */
+    void snapshotChanged(std::string_view path,
+                         std::optional<InterfaceId> id);
+
+    /** @brief Publish the objects changed since the last snapshot. */
+    void publishSnapshot();
+
+    /** @brief Note a DBus client set properties of an interface.
+     *
+     *  Unlike those set by event actions, the values are persisted, once
+     *  the transaction is committed if one is open.  The snapshot is
+     *  left to the caller.
+     *
+     *  @param[in] path - The absolute object path.
+     *  @param[in] id - The interface.
+     */
+    void propertiesWritten(const std::string& path, InterfaceId id);
+
+#ifndef COMPACT_STORE
+    /** @brief sd-bus filter noting Set requests for the bindings.
+     *
+     *  Filters see messages before they are dispatched, so the written
+     *  interfaces are persisted and published afterwards, by
+     *  _writtenSource.
+     */
+    static int noteWrite(sd_bus_message* m, void* data,
+                         sd_bus_error* error) noexcept;
+#endif
+
+    /** @brief Stage an object's new state in the shared memory view.
+     *
+     *  @param[in] path - The absolute object path.
+     *  @param[in] object - The object, as staged in the snapshot.
+     */
+    void updateSharedView(std::string_view path, const SnapshotObject& object);
+
+    /** @brief Run one event loop iteration. */
+    void iterate();
+
+    /** @brief Filter an event and run its actions.
+     *
+     *  @param[in] msg - The message that triggered the event.
+     *  @param[in] event - The event's filters.
+     *  @param[in] info - The event's filters and actions.
+     */
+    Task<> runEvent(sdbusplus::message_t msg, const Event& event,
+                    const EventInfo& info);
+
+    /** @brief Resume events waiting to run their next action.
+     *
+     *  @param[in] budget - Stop once an event suspends after this long.
+     *      The budget is in clock ticks, so duration::max() runs every
+     *      queued action without overflowing the comparison.
+     */
+    void runActions(std::chrono::steady_clock::duration budget);
+
+    /** @brief Awaited before each action, to queue it behind bus
+     *      messages and updates.
+     */
+    struct ActionTurn
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            mgr._actionJobs.push_back(h);
+            mgr._actionSource.set_enabled(sdeventplus::source::Enabled::On);
+        }
+
+        void await_resume() const noexcept {}
+
+        Manager& mgr;
+    };
+
     /** @brief Path prefix applied to any relative paths. */
     const char* _root;
 
@@ -187,6 +613,71 @@ class Manager final : public ServerObject<ManagerIface>
     /** @brief A container contexts for signal callbacks. */
     SigArgs _sigargs;
 
+    /** @brief Counters reported by statistics(). */
+    struct Statistics
+    {
+        /** @brief Property values received for existing interfaces. */
+        std::uint64_t propertiesReceived = 0;
+
+        /** @brief Received values equal to the current ones. */
+        std::uint64_t propertiesUnchanged = 0;
+
+        /** @brief Interface updates not persisted, having no changes. */
+        std::uint64_t serializationsSkipped = 0;
+
+        /** @brief Notify calls refused because the queue was full. */
+        std::uint64_t notifyRejected = 0;
+
+        /** @brief Queued property values replaced by newer ones. */
+        std::uint64_t notifySuperseded = 0;
+
+        /** @brief Queued objects that could not be applied. */
+        std::uint64_t notifyFailed = 0;
+
+        /** @brief Event actions run. */
+        std::uint64_t actionsRun = 0;
+
+        /** @brief Action slices that ran out of time with work left. */
+        std::uint64_t actionSlicesYielded = 0;
+
+        /** @brief Event loop iterations that dispatched work. */
+        std::uint64_t loopIterations = 0;
+
+        /** @brief Time spent dispatching, in microseconds. */
+        std::uint64_t loopDispatchUs = 0;
+
+        /** @brief The longest dispatch, in microseconds. */
+        std::uint64_t loopDispatchMaxUs = 0;
+    } _statistics;
+
+    /** @brief Notify updates waiting to be applied, merged by object.
+     *
+     *  Only used if NOTIFY_QUEUE_LIMIT is set.
+     */
+    std::map<sdbusplus::object_path, Object> _queued;
+
+    /** @brief Work deferred by an open transaction. */
+    struct Transaction
+    {
+        /** @brief The beginTransaction() nesting depth. */
+        unsigned depth = 0;
+
+        /** @brief The client that began the transaction. */
+        std::string owner;
+
+        /** @brief Watches for a bus client owner going away. */
+        std::optional<sdbusplus::bus::match_t> ownerWatch;
+
+        /** @brief Interfaces to persist, by object path. */
+        std::map<std::string, std::vector<InterfaceId>, std::less<>> unsaved;
+
+        /** @brief Objects created, waiting for their associations. */
+        std::vector<std::string> created;
+    } _transaction;
+
+    /** @brief Signals waiting to be flushed, by object path. */
+    std::map<std::string, PendingSignals, std::less<>> _pendingSignals;
+
     /** @brief A container of sdbusplus signal matches.  */
     std::vector<sdbusplus::bus::match_t> _matches;
 
@@ -196,19 +687,121 @@ class Manager final : public ServerObject<ManagerIface>
     /** @brief sdbusplus org.freedesktop.DBus.ObjectManager reference. */
     sdbusplus::server::manager_t _manager;
 
+    /** @brief The inventory manager extension methods. */
+    Extensions _extensions;
+
+    /** @brief The event loop the bus and the sources below run on. */
+    sdeventplus::Event _event;
+
+    /** @brief Flushes coalesced signals when their window closes. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic> _signalTimer;
+
+    /** @brief Commits transactions left open too long. */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>
+        _transactionTimer;
+
+    /** @brief Applies queued Notify updates between bus messages. */
+    sdeventplus::source::Defer _drainSource;
+
+    /** @brief Runs deferred event actions, a slice at a time. */
+    sdeventplus::source::Defer _actionSource;
+
+    /** @brief An eventfd shutdown() writes to, to wake the event loop. */
+    struct Wakeup
+    {
+        Wakeup();
+        Wakeup(const Wakeup&) = delete;
+        Wakeup& operator=(const Wakeup&) = delete;
+        Wakeup(Wakeup&&) = delete;
+        Wakeup& operator=(Wakeup&&) = delete;
+        ~Wakeup();
+
+        int fd;
+    } _wakeup;
+
+    /** @brief Clears _wakeup, leaving run() to check the status. */
+    sdeventplus::source::IO _wakeupSource;
+
+#ifndef COMPACT_STORE
+    /** @brief Interfaces DBus clients sent Set requests for, by
+     *      absolute path.
+     */
+    std::map<std::string, std::vector<InterfaceId>, std::less<>> _written;
+
+    /** @brief Persists and publishes the interfaces in _written. */
+    sdeventplus::source::Defer _writtenSource;
+
+    /** @brief The noteWrite() filter registration. */
+    sdbusplus::slot_t _writeFilter{nullptr};
+#endif
+
+    /** @brief Events waiting to run their next action, in order. */
+    std::deque<std::coroutine_handle<>> _actionJobs;
+
+    /** @brief Events whose filters or actions have not finished. */
+    std::uint64_t _eventsInFlight = 0;
+
+    /** @brief Objects changed since the last snapshot, by path, with the
+     *      interfaces whose properties may have changed.
+     */
+    std::map<std::string, std::vector<InterfaceId>, std::less<>>
+        _snapshotDirty;
+
+    /** @brief Publishes inventory snapshots to reader threads. */
+    SnapshotPublisher _snapshots;
+
+    /** @brief The interfaces changed in each snapshot version. */
+    ChangeLog _changeLog{CHANGE_LOG_SIZE};
+
+    /** @brief Publishes snapshots to local processes, if enabled. */
+    std::unique_ptr<view::Writer> _sharedView;
+
+    /** @brief Persistence worker threads, when persistence is sharded. */
+    std::unique_ptr<PersistWorkers> _persistWorkers;
+
+    /** @brief Serves peer-to-peer clients, if enabled. */
+    std::unique_ptr<PeerServer> _peerServer;
+
+#ifdef COMPACT_STORE
+    /** @brief Serves the compact store over DBus. */
+    std::unique_ptr<compact::Server> _compactServer;
+#endif
+
+    /** @brief Indexes of the interfaces configured in YAML, by ID. */
+    std::map<InterfaceId, InterfaceIndex> _indexes;
+
+    /** @brief Objects whose properties event actions may have set, to
+     *      index before the next query, by path relative to the root.
+     */
+    std::set<std::string, std::less<>> _reindex;
+
     /** @brief A container of pimgen generated events and responses.  */
     static const Events _events;
 
     /** @brief A container of pimgen generated factory methods.  */
     static const Makers _makers;
 
+    /** @brief The pimgen generated index configuration. */
+    static const IndexConfig _indexConfig;
+
+#ifdef COMPACT_STORE
+    /** @brief The pimgen generated compact store interfaces. */
+    static const CompactInfo _compactInfo;
+#endif
+
     /** @brief Handles creating mapper associations for inventory objects */
 #ifdef CREATE_ASSOCIATIONS
     associations::Manager _associations;
 #endif
 
     /** @brief Manager status indicator */
-    volatile enum class ManagerStatus { STARTING, RUNNING, STOPPING } _status;
+    enum class ManagerStatus
+    {
+        STARTING,
+        RUNNING,
+        STOPPING
+    };
+    std::atomic<ManagerStatus> _status;
 };
 
 } // namespace manager
@@ -0,0 +1,282 @@
+#include "config.h"
+
+#include "peer.hpp"
+
+#include "extensions.hpp"
+#include "manager.hpp"
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/exception.hpp>
+#include <sdbusplus/slot.hpp>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-id128.h>
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+namespace
+{
+/** @brief Throw if an sd-bus call failed. */
+void check(int r, const char* what)
+{
+    if (r < 0)
+    {
+        throw sdbusplus::exception::SdBusError(-r, what);
+    }
+}
+
+/** @brief Start a server side sd-bus connection on a socket.
+ *
+ *  @param[in] fd - The socket, which the connection takes over.
+ */
+sdbusplus::bus_t serve(int fd)
+{
+    sd_bus* b = nullptr;
+    auto r = sd_bus_new(&b);
+    if (r >= 0)
+    {
+        r = sd_bus_set_fd(b, fd, fd);
+    }
+    if (r < 0)
+    {
+        sd_bus_unref(b);
+        close(fd);
+        check(r, "sd_bus_set_fd");
+    }
+
+    sdbusplus::bus_t bus{b, std::false_type{}};
+    sd_id128_t id;
+    check(sd_id128_randomize(&id), "sd_id128_randomize");
+    check(sd_bus_set_server(b, 1, id), "sd_bus_set_server");
+    check(sd_bus_start(b), "sd_bus_start");
+    return bus;
+}
+
+/** @brief Register a method callback for an object path. */
+sdbusplus::slot_t addObject(sdbusplus::bus_t& bus, const char* path,
+                            sd_bus_message_handler_t callback, void* context)
+{
+    sd_bus_slot* slot = nullptr;
+    check(sd_bus_add_object(bus.get(), &slot, path, callback, context),
+          "sd_bus_add_object");
+    return sdbusplus::slot_t{slot};
+}
+
+/** @class PeerManager
+ *  @brief The Manager interface of a peer connection.
+ *
+ *  Updates are applied by the manager as if they came from the bus.
+ */
+class PeerManager final : public ServerObject<ManagerIface>
+{
+  public:
+    PeerManager(sdbusplus::bus_t& bus, const char* root, Manager& manager) :
+        ServerObject<ManagerIface>(bus, root), _manager(manager)
+    {}
+
+    void notify(NotifyObjects objs) override
+    {
+        _manager.notify(std::move(objs));
+    }
+
+  private:
+    Manager& _manager;
+};
+
+constexpr auto disconnectedMatch =
+    "type='signal',path='/org/freedesktop/DBus/Local',"
+    "interface='org.freedesktop.DBus.Local',member='Disconnected'";
+} // namespace
+
+struct PeerServer::Peer
+{
+    Peer(int fd, PeerServer& server) :
+        server(server), name("peer:" + std::to_string(fd)), bus(serve(fd)),
+        manager(bus, server._root, server._manager),
+        extensions(bus, server._root, server._manager, name),
+        objectManager(addObject(bus, server._root, PeerServer::objectManager,
+                                &server)),
+        disconnect(bus, disconnectedMatch, PeerServer::disconnected, this)
+    {
+        bus.attach_event(server._event.get(), SD_EVENT_PRIORITY_NORMAL);
+    }
+
+    PeerServer& server;
+
+    /** @brief The client's name, for the transaction it may own. */
+    std::string name;
+
+    /** @brief Set once the client went away. */
+    bool closed = false;
+
+    /** @brief The connection.  The members below are registered on it. */
+    sdbusplus::bus_t bus;
+
+    PeerManager manager;
+    Extensions extensions;
+    sdbusplus::slot_t objectManager;
+    sdbusplus::bus::match_t disconnect;
+};
+
+PeerServer::Socket::Socket(const char* path) :
+    path(path), fd(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                          0))
+{
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (this->path.size() >= sizeof(addr.sun_path))
+    {
+        close(fd);
+        throw std::system_error(ENAMETOOLONG, std::generic_category(),
+                                this->path);
+    }
+    std::strcpy(addr.sun_path, path);
+
+    // Only root, or the user PIM runs as, may connect.
+    unlink(path);
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        chmod(path, S_IRUSR | S_IWUSR) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        auto e = errno;
+        close(fd);
+        throw std::system_error(e, std::generic_category(), this->path);
+    }
+}
+
+PeerServer::Socket::~Socket()
+{
+    close(fd);
+    unlink(path.c_str());
+}
+
+PeerServer::PeerServer(const sdeventplus::Event& event, const char* path,
+                       const char* root, Manager& manager) :
+    _event(event), _root(root), _manager(manager), _socket(path),
+    _listener(event, _socket.fd, EPOLLIN, [this](auto&, auto, auto) {
+        accept();
+    }),
+    _reaper(event, [this](auto& source) {
+        _peers.remove_if([](const auto& peer) { return peer->closed; });
+        source.set_enabled(sdeventplus::source::Enabled::Off);
+    })
+{
+    _reaper.set_enabled(sdeventplus::source::Enabled::Off);
+}
+
+PeerServer::~PeerServer() = default;
+
+void PeerServer::accept()
+{
+    while (true)
+    {
+        auto fd = accept4(_socket.fd, nullptr, nullptr,
+                          SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                lg2::error("Failed to accept a peer: {ERROR}", "ERROR",
+                           std::strerror(errno));
+            }
+            return;
+        }
+
+        try
+        {
+            _peers.push_back(std::make_unique<Peer>(fd, *this));
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to start a peer connection: {ERROR}", "ERROR",
+                       e);
+        }
+    }
+}
+
+int PeerServer::objectManager(sd_bus_message* msg, void* context,
+                              sd_bus_error* error)
+{
+    // Leave any other method to the interfaces registered at the root.
+    if (sd_bus_message_is_method_call(msg, "org.freedesktop.DBus.ObjectManager",
+                                      "GetManagedObjects") <= 0)
+    {
+        return 0;
+    }
+
+    auto& self = *static_cast<PeerServer*>(context);
+    return handleMethod(msg, error, [&self](auto& m) {
+        auto snapshot = self._manager.snapshot();
+        auto reply = m.new_method_return();
+        auto* r = reply.get();
+        std::string path{self._root};
+        auto rootLength = path.size();
+
+        check(sd_bus_message_open_container(r, 'a', "{oa{sa{sv}}}"),
+              "GetManagedObjects");
+        for (const auto& [relPath, object] : snapshot->objects)
+        {
+            path.resize(rootLength);
+            path.append(relPath);
+            check(sd_bus_message_open_container(r, 'e', "oa{sa{sv}}"),
+                  "GetManagedObjects");
+            reply.append(sdbusplus::object_path{path});
+            check(sd_bus_message_open_container(r, 'a', "{sa{sv}}"),
+                  "GetManagedObjects");
+            for (const auto& [interface, properties] : *object)
+            {
+                check(sd_bus_message_open_container(r, 'e', "sa{sv}"),
+                      "GetManagedObjects");
+                reply.append(interface, *properties);
+                check(sd_bus_message_close_container(r), "GetManagedObjects");
+            }
+            check(sd_bus_message_close_container(r), "GetManagedObjects");
+            check(sd_bus_message_close_container(r), "GetManagedObjects");
+        }
+        check(sd_bus_message_close_container(r), "GetManagedObjects");
+        reply.method_return();
+    });
+}
+
+int PeerServer::disconnected(sd_bus_message*, void* context, sd_bus_error*)
+{
+    // The connection is dispatching; free it from the event loop.
+    auto& peer = *static_cast<Peer*>(context);
+    peer.closed = true;
+    peer.server._reaper.set_enabled(sdeventplus::source::Enabled::On);
+    try
+    {
+        peer.server._manager.clientGone(peer.name);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to commit: {ERROR}", "ERROR", e);
+    }
+    return 0;
+}
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <sdeventplus/event.hpp>
+#include <sdeventplus/source/event.hpp>
+#include <sdeventplus/source/io.hpp>
+
+#include <list>
+#include <memory>
+#include <string>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+class Manager;
+
+/** @class PeerServer
+ *  @brief Serves the inventory manager over a private socket.
+ *
+ *  Local clients connect to the socket and speak DBus to PIM directly,
+ *  without going through the bus broker.  Each connection is served
+ *  the Manager interface, the extension methods and
+ *  org.freedesktop.DBus.ObjectManager.GetManagedObjects at the
+ *  inventory root.  No signals are sent over these connections.
+ */
+class PeerServer
+{
+  public:
+    PeerServer() = delete;
+    PeerServer(const PeerServer&) = delete;
+    PeerServer& operator=(const PeerServer&) = delete;
+    PeerServer(PeerServer&&) = delete;
+    PeerServer& operator=(PeerServer&&) = delete;
+    ~PeerServer();
+
+    /** @brief Listen on a socket.
+     *
+     *  @param[in] event - The event loop to serve clients on.
+     *  @param[in] path - The socket path.  Any file there is replaced.
+     *  @param[in] root - The inventory root path.
+     *  @param[in] manager - The manager to serve.
+     */
+    PeerServer(const sdeventplus::Event& event, const char* path,
+               const char* root, Manager& manager);
+
+  private:
+    /** @brief A client connection. */
+    struct Peer;
+
+    /** @struct Socket
+     *  @brief The listening socket, removed on destruction.
+     */
+    struct Socket
+    {
+        Socket(const char* path);
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+        Socket(Socket&&) = delete;
+        Socket& operator=(Socket&&) = delete;
+        ~Socket();
+
+        std::string path;
+        int fd;
+    };
+
+    /** @brief Accept waiting clients. */
+    void accept();
+
+    /** @brief Method callback for the inventory root.
+     *
+     *  Implements org.freedesktop.DBus.ObjectManager.GetManagedObjects,
+     *  which sd-bus does not allow to be registered as a vtable.
+     */
+    static int objectManager(sd_bus_message* msg, void* context,
+                             sd_bus_error* error);
+
+    /** @brief Peer Disconnected signal callback. */
+    static int disconnected(sd_bus_message* msg, void* context,
+                            sd_bus_error* error);
+
+    const sdeventplus::Event& _event;
+    const char* _root;
+    Manager& _manager;
+
+    Socket _socket;
+
+    /** @brief Calls accept() when clients are waiting. */
+    sdeventplus::source::IO _listener;
+
+    /** @brief Frees the connections of clients that went away. */
+    sdeventplus::source::Defer _reaper;
+
+    std::list<std::unique_ptr<Peer>> _peers;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
@@ -16,6 +16,7 @@ The parser workflow is broken down as follows:
 """
 
 import argparse
+import json
 import os
 import sys
 
@@ -28,6 +29,11 @@ from sdbusplus.renderer import Renderer
 # Global busname for use within classes where necessary
 busname = "xyz.openbmc_project.Inventory.Manager"
 
+# Global interface properties, and whether they are kept in the compact
+# store, for use within classes where necessary
+interface_properties = None
+compact_store = False
+
 
 def cppTypeName(yaml_type):
     """Convert yaml types to cpp types."""
@@ -37,8 +43,9 @@ def cppTypeName(yaml_type):
 class InterfaceComposite(object):
     """Compose interface properties."""
 
-    def __init__(self, dict):
+    def __init__(self, dict, enumerations=None):
         self.dict = dict
+        self.enumerations = enumerations or {}
 
     def interfaces(self):
         return list(self.dict.keys())
@@ -51,6 +58,280 @@ class InterfaceComposite(object):
             ]
         return names
 
+    def properties(self, interface):
+        return [
+            CompactProperty(interface, x, self.enumerations)
+            for x in self.dict[interface] or []
+        ]
+
+    def property(self, interface, name):
+        """Describe a property, or None if there is no such property."""
+        if interface not in self.dict:
+            return None
+        return next(
+            (x for x in self.properties(interface) if x.name == name), None
+        )
+
+    def compact(self, interface):
+        """The properties the compact store can keep.
+
+        Properties of types Notify cannot carry are left out; see fixed().
+        """
+        return [x for x in self.properties(interface) if x.supported()]
+
+    def fixed(self, interface):
+        """The properties served read-only with their default values."""
+        return [x for x in self.properties(interface) if x.fixed]
+
+
+class CompactProperty(object):
+    """Describe a property as kept in the compact store."""
+
+    # The signature and InterfaceVariantType alternative of each
+    # supported YAML type.  Enumerations are kept as strings.
+    types = {
+        "boolean": ("b", "bool"),
+        "uint16": ("q", "uint16_t"),
+        "int64": ("x", "int64_t"),
+        "uint64": ("t", "size_t"),
+        "size": ("t", "size_t"),
+        "string": ("s", "std::string"),
+        "array[byte]": ("ay", "std::vector<uint8_t>"),
+        "array[string]": ("as", "std::vector<std::string>"),
+    }
+
+    # The signature of each basic YAML type, for properties served with
+    # their defaults.
+    signatures = {
+        "boolean": "b",
+        "byte": "y",
+        "int16": "n",
+        "uint16": "q",
+        "int32": "i",
+        "uint32": "u",
+        "int64": "x",
+        "uint64": "t",
+        "size": "t",
+        "ssize": "x",
+        "double": "d",
+        "string": "s",
+        "object_path": "o",
+        "signature": "g",
+    }
+
+    # The limits of the integer types, for maxint and minint defaults.
+    limits = {
+        "byte": (0, 2**8 - 1),
+        "int16": (-(2**15), 2**15 - 1),
+        "uint16": (0, 2**16 - 1),
+        "int32": (-(2**31), 2**31 - 1),
+        "uint32": (0, 2**32 - 1),
+        "int64": (-(2**63), 2**63 - 1),
+        "uint64": (0, 2**64 - 1),
+        "size": (0, 2**64 - 1),
+        "ssize": (-(2**63), 2**63 - 1),
+    }
+
+    def __init__(self, interface, prop, enumerations):
+        self.name = prop["name"]
+        self.flags = prop.get("flags", []) or []
+        self.enumeration = []
+        self.signature = None
+        # The InterfaceVariantType alternative the value is kept as.
+        self.cpp = None
+        # The default as a JSON value, or None for the type's default.
+        self.value = None
+        # The signature and JSON default of a property the compact store
+        # can't keep, served read-only instead.
+        self.fixed = None
+
+        t = prop["type"]
+        default = prop.get("default", None)
+        if t.startswith("enum[") and t.endswith("]"):
+            values, prefix = self.enumeration_of(
+                interface, t[len("enum[") : -1], enumerations
+            )
+            if not values:
+                # Without its values the enumeration can't be checked,
+                # but its default can still be served.
+                if default is not None:
+                    self.fixed = ("s", prefix + str(default).split(".")[-1])
+                return
+            self.enumeration = [prefix + v["name"] for v in values]
+            self.signature = "s"
+            self.cpp = "std::string"
+            if default is None:
+                self.value = self.enumeration[0]
+            else:
+                self.value = prefix + str(default).split(".")[-1]
+            self.init = 'std::string("%s")' % self.value
+        elif t in self.types:
+            self.signature, cpp = self.types[t]
+            self.cpp = cpp
+            if default is None or t.startswith("array"):
+                self.init = "%s{}" % cpp
+            elif t == "boolean":
+                self.value = bool(default)
+                self.init = "true" if default else "false"
+            elif t == "string":
+                self.value = str(default)
+                self.init = 'std::string("%s")' % default
+            elif default in ("maxint", "minint"):
+                low, high = self.limits[t]
+                self.value = high if default == "maxint" else low
+                self.init = "std::numeric_limits<%s>::%s()" % (
+                    cpp,
+                    default[:3],
+                )
+            else:
+                self.value = int(default)
+                self.init = "%s{%s}" % (cpp, default)
+        elif t in self.signatures:
+            self.fixed = (
+                self.signatures[t],
+                self.zero(self.signatures[t])
+                if default is None
+                else self.basic_default(t, default),
+            )
+        else:
+            # Containers are served empty, or for structs and variants,
+            # holding the defaults of their members.
+            self.fixed = self.describe_type(interface, t, enumerations)
+
+    @staticmethod
+    def enumeration_of(interface, name, enumerations):
+        """The values of an enumeration and the prefix of their names.
+
+        The values are None if the declaring interface wasn't scanned.
+        """
+        if name.startswith("self."):
+            owner, enum = interface, name[len("self.") :]
+        else:
+            owner, _, enum = name.rpartition(".")
+        values = next(
+            (
+                e["values"]
+                for e in enumerations.get(owner, [])
+                if e["name"] == enum
+            ),
+            None,
+        )
+        return values, "%s.%s." % (owner, enum)
+
+    @staticmethod
+    def split_type(t):
+        """Split a YAML type into its name and parameters."""
+        if "[" not in t:
+            return t, []
+        name, rest = t[:-1].split("[", 1)
+        params = []
+        depth = 0
+        start = 0
+        for i, c in enumerate(rest):
+            if c == "[":
+                depth += 1
+            elif c == "]":
+                depth -= 1
+            elif c == "," and depth == 0:
+                params.append(rest[start:i].strip())
+                start = i + 1
+        params.append(rest[start:].strip())
+        return name, params
+
+    @staticmethod
+    def zero(signature):
+        """The default of a basic type."""
+        return {"b": False, "d": 0.0, "s": "", "o": "/", "g": ""}.get(
+            signature, 0
+        )
+
+    def basic_default(self, t, default):
+        """The JSON value of a basic type's YAML default."""
+        if t == "boolean":
+            return bool(default)
+        if t in ("string", "object_path", "signature"):
+            return str(default)
+        if t == "double":
+            # Doubles that aren't finite are written as strings.
+            nonfinite = ("nan", "inf", "infinity", "-inf", "-infinity")
+            if str(default).lower() in nonfinite:
+                return str(default)
+            if default == "maxint":
+                return sys.float_info.max
+            if default == "minint":
+                return sys.float_info.min
+            if default == "epsilon":
+                return sys.float_info.epsilon
+            return float(default)
+        if default in ("maxint", "minint"):
+            low, high = self.limits[t]
+            return high if default == "maxint" else low
+        return int(default)
+
+    def describe_type(self, interface, t, enumerations):
+        """The signature and default JSON value of a YAML type, or None
+        if it can't be served.
+        """
+        name, params = self.split_type(t)
+        if name in self.signatures and not params:
+            return self.signatures[name], self.zero(self.signatures[name])
+        if name == "enum" and len(params) == 1:
+            values, prefix = self.enumeration_of(
+                interface, params[0], enumerations
+            )
+            return ("s", prefix + values[0]["name"]) if values else None
+
+        members = [
+            self.describe_type(interface, p, enumerations) for p in params
+        ]
+        if not members or None in members:
+            return None
+        if name == "array" and len(members) == 1:
+            return "a" + members[0][0], []
+        if name == "dict" and len(members) == 2:
+            return "a{%s%s}" % (members[0][0], members[1][0]), []
+        if name == "struct":
+            return (
+                "(%s)" % "".join(m[0] for m in members),
+                [m[1] for m in members],
+            )
+        if name == "variant":
+            return "v", list(members[0])
+        return None
+
+    def fixed_value(self):
+        """The default of a fixed property as JSON text."""
+        return json.dumps(self.fixed[1], separators=(",", ":"))
+
+    def supported(self):
+        return self.signature is not None
+
+    def vtable_flags(self):
+        if "const" in self.flags:
+            return "sdbusplus::vtable::property_::const_"
+        return "sdbusplus::vtable::property_::emits_change"
+
+    def writable(self):
+        return "const" not in self.flags and "readonly" not in self.flags
+
+    def describe(self):
+        """Describe the property for compact::Registry."""
+        if self.fixed:
+            return {
+                "name": self.name,
+                "signature": self.fixed[0],
+                "default": self.fixed[1],
+                "fixed": True,
+            }
+        d = {"name": self.name, "signature": self.signature}
+        if self.value is not None:
+            d["default"] = self.value
+        if self.enumeration:
+            d["enumeration"] = self.enumeration
+        if self.flags:
+            d["flags"] = self.flags
+        return d
+
 
 class Interface(list):
     """Provide various interface transformations."""
@@ -329,6 +610,12 @@ class DestroyObjects(MethodCall):
         super(DestroyObjects, self).__init__(**kw)
 
 
+class DestroySubtrees(DestroyObjects):
+    """Assemble a destroySubtrees functor."""
+
+    pass
+
+
 class SetProperty(MethodCall):
     """Assemble a setProperty functor."""
 
@@ -349,6 +636,26 @@ class SetProperty(MethodCall):
         member_type = cppTypeName(value["type"])
         member_cast = "{0} ({1}::*)({0})".format(member_type, t.qualified())
 
+        # The compact store keeps the property as its declared type, so
+        # the value is converted to that.
+        compact_type = member_type
+        declared = (
+            interface_properties.property(str(iface), prop)
+            if interface_properties
+            else None
+        )
+        if declared is not None and declared.supported():
+            compact_type = declared.cpp
+        elif compact_store and declared is None:
+            raise ValueError(
+                "Cannot set unknown property %s of %s" % (prop, iface)
+            )
+        elif compact_store:
+            raise ValueError(
+                "Cannot set %s of %s: the compact store serves it read-only"
+                % (prop, iface)
+            )
+
         paths = [{"value": x, "type": "string"} for x in kw.pop("paths")]
         args.append(
             InitializerList(values=[TrivialArgument(**x) for x in paths])
@@ -361,6 +668,7 @@ class SetProperty(MethodCall):
 
         args.append(InitializerList(values=conditions))
         args.append(TrivialArgument(value=str(iface), type="string"))
+        args.append(TrivialArgument(value=prop, type="string"))
         args.append(
             TrivialArgument(
                 value=member, decorators=[Cast("static", member_cast)]
@@ -368,7 +676,10 @@ class SetProperty(MethodCall):
         )
         args.append(TrivialArgument(**value))
 
-        kw["templates"] = [Template(name=name, namespace=namespace)]
+        kw["templates"] = [
+            Template(name=name, namespace=namespace),
+            Template(name=compact_type, namespace=[]),
+        ]
         kw["args"] = args
         kw["namespace"] = ["functor"]
         super(SetProperty, self).__init__(**kw)
@@ -463,6 +774,7 @@ class Event(MethodCall):
 
     functor_map = {
         "destroyObjects": DestroyObjects,
+        "destroySubtrees": DestroySubtrees,
         "createObjects": CreateObjects,
         "propertyChangedTo": PropertyChanged,
         "propertyIs": PropertyIs,
@@ -559,25 +871,64 @@ class Everything(Renderer):
                     for e in yaml.safe_load(fd.read()).get("events", {}):
                         events.append(e)
 
-        interfaces, interface_composite = Everything.get_interfaces(
-            args.ifacesdir
-        )
+        # Aggregate the index YAML in the indexes.d directory.
+        indexes = []
+        indexes_dir = os.path.join(args.inputdir, "indexes.d")
+
+        if os.path.exists(indexes_dir):
+            yaml_files = [
+                x for x in os.listdir(indexes_dir) if x.endswith(".yaml")
+            ]
+
+            for x in yaml_files:
+                with open(os.path.join(indexes_dir, x), "r") as fd:
+                    for i in yaml.safe_load(fd.read()).get("indexes", {}):
+                        indexes.append(i)
+
+        (
+            interfaces,
+            interface_composite,
+            enumerations,
+        ) = Everything.get_interfaces(args.ifacesdir)
         (
             extra_interfaces,
             extra_interface_composite,
+            extra_enumerations,
         ) = Everything.get_interfaces(
             os.path.join(args.inputdir, "extra_interfaces.d")
         )
         interface_composite.update(extra_interface_composite)
-        interface_composite = InterfaceComposite(interface_composite)
+        enumerations.update(extra_enumerations)
+        interface_composite = InterfaceComposite(
+            interface_composite, enumerations
+        )
         # Update busname if configured differently than the default
         global busname
         busname = args.busname
+        global interface_properties
+        interface_properties = interface_composite
+        global compact_store
+        compact_store = args.compact_store
+
+        for i in indexes:
+            interface = i["interface"]
+            if interface not in interface_composite.interfaces():
+                raise ValueError(
+                    "Cannot index unsupported interface %s" % interface
+                )
+            names = [x.name for x in interface_composite.names(interface)]
+            for p in i.get("properties", []):
+                if p not in names:
+                    raise ValueError(
+                        "Cannot index unknown property %s of %s"
+                        % (p, interface)
+                    )
 
         return Everything(
             *events,
             interfaces=interfaces + extra_interfaces,
-            interface_composite=interface_composite
+            interface_composite=interface_composite,
+            indexes=indexes
         )
 
     @staticmethod
@@ -587,6 +938,7 @@ class Everything(Renderer):
         yaml_files = []
         interfaces = []
         interface_composite = {}
+        enumerations = {}
 
         if targetdir and os.path.exists(targetdir):
             for directory, _, files in os.walk(targetdir):
@@ -634,13 +986,19 @@ class Everything(Renderer):
                     if any("path" in p["type"] for p in properties):
                         continue
                 interface_composite[i] = properties
+                enumerations[i] = parsed.get("enumerations", None) or []
                 interfaces.append(i)
 
-        return interfaces, interface_composite
+        return interfaces, interface_composite, enumerations
 
     def __init__(self, *a, **kw):
-        self.interfaces = [Interface(x) for x in kw.pop("interfaces", [])]
+        # The position of an interface in the sorted list is its ID.
+        # See Manager::Makers.
+        self.interfaces = [
+            Interface(x) for x in sorted(set(kw.pop("interfaces", [])))
+        ]
         self.interface_composite = kw.pop("interface_composite", {})
+        self.indexes = kw.pop("indexes", [])
         self.events = [self.class_map[x["type"]](**x) for x in a]
         super(Everything, self).__init__(**kw)
 
@@ -653,10 +1011,30 @@ class Everything(Renderer):
                     "generated.cpp.mako",
                     events=self.events,
                     interfaces=self.interfaces,
+                    interface_composite=self.interface_composite,
+                    indexes=self.indexes,
                     indent=Indent(),
                 )
             )
 
+    def generate_interfaces(self, loader):
+        """Describe the interfaces for loading at runtime."""
+        description = {
+            "interfaces": [
+                {
+                    "name": str(i),
+                    "properties": [
+                        p.describe()
+                        for p in self.interface_composite.properties(str(i))
+                        if p.supported() or p.fixed
+                    ],
+                }
+                for i in self.interfaces
+            ]
+        }
+        with open(os.path.join(args.outputdir, "interfaces.json"), "w") as fd:
+            json.dump(description, fd, indent=4)
+
     def generate_serialization(self, loader):
         with open(
             os.path.join(args.outputdir, "gen_serialization.hpp"), "w"
@@ -676,6 +1054,7 @@ if __name__ == "__main__":
     valid_commands = {
         "generate-cpp": "generate_cpp",
         "generate-serialization": "generate_serialization",
+        "generate-interfaces": "generate_interfaces",
     }
 
     parser = argparse.ArgumentParser(
@@ -710,6 +1089,13 @@ if __name__ == "__main__":
         default="xyz.openbmc_project.Inventory.Manager",
         help="Inventory manager busname.",
     )
+    parser.add_argument(
+        "-c",
+        "--compact-store",
+        dest="compact_store",
+        action="store_true",
+        help="Keep properties in the compact store.",
+    )
     parser.add_argument(
         "command",
         metavar="COMMAND",
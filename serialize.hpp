@@ -5,8 +5,21 @@
 #include <cereal/archives/json.hpp>
 #include <phosphor-logging/lg2.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <latch>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace phosphor
 {
@@ -27,10 +40,273 @@ inline fs::path getStoragePath(const std::string& path,
     p /= fs::path(iface).relative_path();
     return p;
 }
+
+/** @brief Persisted interface names, by relative object path. */
+using PersistedObjects =
+    std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string>,
+                  std::less<>>;
+
+/** @brief Find the persisted inventory.
+ *
+ *  The containers returned are only needed until the objects are
+ *  restored, so callers can provide an arena for them.
+ *
+ *  @param[in] store - The persistent storage directory.
+ *  @param[in] root - The inventory root path.
+ *  @param[in] resource - Memory resource for the returned containers.
+ *
+ *  @returns The persisted interfaces of each object, by object path
+ *      relative to root.
+ */
+inline PersistedObjects scanStorage(const fs::path& store,
+                                    std::string_view root,
+                                    std::pmr::memory_resource* resource)
+{
+    PersistedObjects objects{resource};
+
+    if (!fs::exists(store))
+    {
+        return objects;
+    }
+
+    const auto prefix = store.native().size() + root.size();
+    for (const auto& dirent : fs::recursive_directory_iterator(store))
+    {
+        if (!dirent.is_regular_file())
+        {
+            continue;
+        }
+
+        // The file name is the interface and the parent directory is
+        // the object.
+        std::string_view path{dirent.path().native()};
+        auto slash = path.rfind('/');
+        if (slash == std::string_view::npos || slash < prefix)
+        {
+            continue;
+        }
+
+        auto object = path.substr(prefix, slash - prefix);
+        auto it = objects.find(object);
+        if (it == objects.end())
+        {
+            it = objects
+                     .emplace(std::piecewise_construct,
+                              std::forward_as_tuple(object),
+                              std::forward_as_tuple())
+                     .first;
+        }
+        it->second.emplace_back(path.substr(slash + 1));
+    }
+
+    return objects;
+}
 } // namespace detail
 
+/** @class PersistWorkers
+ *  @brief Writes persisted state on worker threads, one per subtree.
+ *
+ *  Each configured subtree, and everything outside them, has its own
+ *  queue and thread.  Work on a path always goes to the same queue, so
+ *  it is done in order.
+ */
+class PersistWorkers
+{
+  public:
+    PersistWorkers() = delete;
+    PersistWorkers(const PersistWorkers&) = delete;
+    PersistWorkers& operator=(const PersistWorkers&) = delete;
+    PersistWorkers(PersistWorkers&&) = delete;
+    PersistWorkers& operator=(PersistWorkers&&) = delete;
+
+    /** @brief Start the workers.
+     *
+     *  @param[in] roots - The object paths of the subtrees to give their
+     *      own worker.
+     */
+    explicit PersistWorkers(const std::vector<std::string>& roots)
+    {
+        _shards.push_back(std::make_unique<Shard>(std::string()));
+        for (const auto& root : roots)
+        {
+            _shards.push_back(std::make_unique<Shard>(root));
+        }
+    }
+
+    /** @brief Finish the queued work and stop the workers. */
+    ~PersistWorkers() = default;
+
+    /** @brief Queue writing a file.
+     *
+     *  @param[in] path - The object path the file belongs to.
+     *  @param[in] file - The file to write.
+     *  @param[in] data - The file contents.
+     */
+    void write(std::string_view path, fs::path&& file, std::string&& data)
+    {
+        shard(path).push([file = std::move(file), data = std::move(data)]() {
+            fs::create_directories(file.parent_path());
+            std::ofstream os(file, std::ios::binary);
+            os << data;
+        });
+    }
+
+    /** @brief Queue removing a file.
+     *
+     *  @param[in] path - The object path the file belongs to.
+     *  @param[in] file - The file to remove.
+     */
+    void remove(std::string_view path, fs::path&& file)
+    {
+        shard(path).push([file = std::move(file)]() {
+            std::error_code ec;
+            fs::remove(file, ec);
+            if (ec)
+            {
+                lg2::error("Failed to remove {FILE}: {ERROR}", "FILE",
+                           file.string(), "ERROR", ec.message());
+            }
+        });
+    }
+
+    /** @brief Queue removing the persisted state of a subtree.
+     *
+     *  The subtree's shard does the removal after its queued work.  The
+     *  shards of subtrees below it stop at the same point, so their
+     *  earlier writes are removed too and their later ones are kept.
+     *
+     *  @param[in] path - The object path of the subtree.
+     *  @param[in] dir - The directory to remove.
+     */
+    void removeAll(std::string_view path, fs::path&& dir)
+    {
+        auto& owner = shard(path);
+        std::vector<Shard*> below;
+        for (auto& s : _shards)
+        {
+            const auto& root = s->root;
+            if (s.get() != &owner && root.size() > path.size() &&
+                root.starts_with(path) && root[path.size()] == '/')
+            {
+                below.push_back(s.get());
+            }
+        }
+
+        // Jobs are queued in the same order on every shard, so the
+        // shards waiting on each other can't deadlock.
+        auto arrived = std::make_shared<std::latch>(below.size());
+        auto removed = std::make_shared<std::latch>(1);
+        for (auto* s : below)
+        {
+            s->push([arrived, removed]() {
+                arrived->count_down();
+                removed->wait();
+            });
+        }
+        owner.push([arrived, removed, dir = std::move(dir)]() {
+            arrived->wait();
+            std::error_code ec;
+            fs::remove_all(dir, ec);
+            removed->count_down();
+            if (ec)
+            {
+                lg2::error("Failed to remove {DIR}: {ERROR}", "DIR",
+                           dir.string(), "ERROR", ec.message());
+            }
+        });
+    }
+
+    /** @brief Wait for all queued work to be done. */
+    void flush()
+    {
+        for (auto& s : _shards)
+        {
+            std::unique_lock lock(s->mutex);
+            s->done.wait(lock, [&]() { return s->outstanding == 0; });
+        }
+    }
+
+  private:
+    struct Shard
+    {
+        explicit Shard(std::string r) :
+            root(std::move(r)),
+            thread([this](std::stop_token stop) { run(stop); })
+        {}
+
+        void push(std::function<void()>&& job)
+        {
+            {
+                std::lock_guard lock(mutex);
+                jobs.push_back(std::move(job));
+                ++outstanding;
+            }
+            ready.notify_one();
+        }
+
+        void run(std::stop_token stop)
+        {
+            std::unique_lock lock(mutex);
+            // Once stopping, the queue is emptied before returning.
+            while (ready.wait(lock, stop, [&]() { return !jobs.empty(); }))
+            {
+                auto job = std::move(jobs.front());
+                jobs.pop_front();
+                lock.unlock();
+                try
+                {
+                    job();
+                }
+                catch (const std::exception& e)
+                {
+                    lg2::error("Persisting inventory failed: {ERROR}",
+                               "ERROR", e);
+                }
+                lock.lock();
+                if (--outstanding == 0)
+                {
+                    done.notify_all();
+                }
+            }
+        }
+
+        /** @brief The subtree's object path, empty for the rest. */
+        std::string root;
+
+        std::mutex mutex;
+        std::condition_variable_any ready;
+        std::condition_variable done;
+        std::deque<std::function<void()>> jobs;
+        std::size_t outstanding = 0;
+
+        /** @brief Declared last, so it is joined before the rest go. */
+        std::jthread thread;
+    };
+
+    /** @brief The shard with the longest root containing path. */
+    Shard& shard(std::string_view path)
+    {
+        Shard* best = _shards.front().get();
+        for (auto& s : _shards)
+        {
+            const auto& root = s->root;
+            if (root.size() > best->root.size() && path.starts_with(root) &&
+                (path.size() == root.size() || path[root.size()] == '/'))
+            {
+                best = s.get();
+            }
+        }
+        return *best;
+    }
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+};
+
 struct SerialOps
 {
+    /** @brief Set when persisted state is written by worker threads. */
+    static inline PersistWorkers* workers = nullptr;
+
     /** @brief Serialize inventory item path
      *  Serializing only path for an empty interface to be consistent
      *  interfaces.
@@ -40,6 +316,11 @@ struct SerialOps
     static void serialize(const std::string& path, const std::string& iface)
     {
         auto p = detail::getStoragePath(path, iface);
+        if (workers)
+        {
+            workers->write(path, std::move(p), std::string());
+            return;
+        }
         fs::create_directories(p.parent_path());
         std::ofstream os(p, std::ios::binary);
     }
@@ -55,6 +336,18 @@ struct SerialOps
                           const T& object)
     {
         auto p = detail::getStoragePath(path, iface);
+        if (workers)
+        {
+            // The binding is only safe to read here, so it is encoded
+            // before the write is handed off.
+            std::ostringstream os;
+            {
+                cereal::JSONOutputArchive oarchive(os);
+                oarchive(object);
+            }
+            workers->write(path, std::move(p), std::move(os).str());
+            return;
+        }
         fs::create_directories(p.parent_path());
         std::ofstream os(p, std::ios::binary);
         cereal::JSONOutputArchive oarchive(os);
@@ -92,6 +385,50 @@ struct SerialOps
             fs::remove(p);
         }
     }
+
+    /** @brief Remove a persisted inventory interface
+     *
+     *  @param[in] path - DBus object path
+     *  @param[in] iface - Inventory interface name
+     */
+    static void remove(const std::string& path, const std::string& iface)
+    {
+        if (workers)
+        {
+            workers->remove(path, detail::getStoragePath(path, iface));
+            return;
+        }
+        std::error_code ec;
+        fs::remove(detail::getStoragePath(path, iface), ec);
+        if (ec)
+        {
+            lg2::error("Failed to remove persisted {INTERFACE} of {PATH}: "
+                       "{ERROR}",
+                       "INTERFACE", iface, "PATH", path, "ERROR",
+                       ec.message());
+        }
+    }
+
+    /** @brief Remove the persisted state of an object and its children
+     *
+     *  @param[in] path - DBus object path
+     */
+    static void remove(const std::string& path)
+    {
+        auto p = fs::path(PIM_PERSIST_PATH) / fs::path(path).relative_path();
+        if (workers)
+        {
+            workers->removeAll(path, std::move(p));
+            return;
+        }
+        std::error_code ec;
+        fs::remove_all(p, ec);
+        if (ec)
+        {
+            lg2::error("Failed to remove persisted state of {PATH}: {ERROR}",
+                       "PATH", path, "ERROR", ec.message());
+        }
+    }
 };
 } // namespace manager
 } // namespace inventory
@@ -0,0 +1,778 @@
+#pragma once
+
+/** @file shared_view.hpp
+ *  @brief A read-only inventory image in shared memory.
+ *
+ *  PIM writes an image of its objects and property values to a file on
+ *  tmpfs.  Local readers map the file and copy the image out under a
+ *  sequence lock, so reading takes no IPC and never blocks PIM.  The
+ *  image can lag DBus slightly; DBus remains the authoritative API.
+ *
+ *  This header only depends on the standard library and POSIX, so
+ *  other daemons can include it as is.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace view
+{
+
+/** @brief Where PIM writes the image. */
+constexpr auto defaultPath = "/run/phosphor-inventory-manager/view";
+
+/** @brief A property value.  The same types Notify accepts. */
+using Value =
+    std::variant<bool, size_t, int64_t, uint16_t, std::string,
+                 std::vector<uint8_t>, std::vector<std::string>>;
+
+/** @brief Property values by name, by interface, by object path. */
+using Objects = std::map<
+    std::string, std::map<std::string, std::map<std::string, Value>>>;
+
+namespace detail
+{
+constexpr std::uint32_t magic = 0x50494d56; // "PIMV"
+constexpr std::uint32_t layout = 2;
+
+/** @brief The start of the file.  The image follows it.
+ *
+ *  The image is a sequence of object records, each a 32 bit size, a
+ *  live flag and the object.  An object is updated by clearing the flag
+ *  of its record and appending a new one, so a publish only writes what
+ *  changed.
+ */
+struct Header
+{
+    std::uint32_t magic;
+    std::uint32_t layout;
+
+    /** @brief Set when the writer has stopped or been replaced. */
+    std::atomic<std::uint32_t> retired;
+
+    /** @brief Odd while the writer is changing the image. */
+    std::atomic<std::uint64_t> sequence;
+
+    /** @brief The PIM snapshot version the image holds. */
+    std::atomic<std::uint64_t> version;
+
+    /** @brief The bytes of image. */
+    std::atomic<std::uint64_t> size;
+
+    /** @brief The bytes of file after the header. */
+    std::atomic<std::uint64_t> capacity;
+
+    /** @brief Random, and different for each writer, so versions from
+     *      an earlier PIM are not mistaken for this one's.  Added last,
+     *      so a writer can still retire an image of the earlier layout.
+     */
+    std::uint64_t stream;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The sequence lock needs address-free atomics");
+
+/** @brief A mapping of the whole file. */
+class Mapping
+{
+  public:
+    Mapping() = default;
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+    Mapping(Mapping&& other) noexcept :
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0))
+    {}
+    Mapping& operator=(Mapping&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+        }
+        return *this;
+    }
+    ~Mapping()
+    {
+        reset();
+    }
+
+    /** @brief Map size bytes of fd. */
+    Mapping(int fd, std::size_t size, int prot) : _size(size)
+    {
+        _data = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        if (_data == MAP_FAILED)
+        {
+            _data = nullptr;
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+    }
+
+    Header& header() const noexcept
+    {
+        return *static_cast<Header*>(_data);
+    }
+
+    char* image() const noexcept
+    {
+        return static_cast<char*>(_data) + sizeof(Header);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+  private:
+    void reset() noexcept
+    {
+        if (_data)
+        {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+    }
+
+    void* _data = nullptr;
+    std::size_t _size = 0;
+};
+
+/** @brief An open file descriptor. */
+class File
+{
+  public:
+    explicit File(int fd = -1) noexcept : _fd(fd) {}
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+    File(File&& other) noexcept : _fd(std::exchange(other._fd, -1)) {}
+    File& operator=(File&& other) noexcept
+    {
+        std::swap(_fd, other._fd);
+        return *this;
+    }
+    ~File()
+    {
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+        }
+    }
+
+    int get() const noexcept
+    {
+        return _fd;
+    }
+
+  private:
+    int _fd;
+};
+} // namespace detail
+
+/** @class Encoder
+ *  @brief Builds object records.
+ *
+ *  Objects are added with object(), then each of their interfaces with
+ *  interface(), then each interface's properties with property().  The
+ *  counts given must match what is added.
+ */
+class Encoder
+{
+  public:
+    void object(std::string_view path, std::uint32_t interfaces)
+    {
+        finish();
+        _record = _buffer.size();
+        integer(std::uint32_t(0));
+        integer(std::uint8_t(1));
+        string(path);
+        integer(interfaces);
+    }
+
+    void interface(std::string_view name, std::uint32_t properties)
+    {
+        string(name);
+        integer(properties);
+    }
+
+    void property(std::string_view name, const Value& value)
+    {
+        string(name);
+        integer(static_cast<std::uint8_t>(value.index()));
+        std::visit([this](const auto& v) { encode(v); }, value);
+    }
+
+    /** @brief The finished records. */
+    std::string_view image()
+    {
+        finish();
+        return _buffer;
+    }
+
+  private:
+    /** @brief Fill in the size of the last record. */
+    void finish()
+    {
+        if (_record != _buffer.size())
+        {
+            std::uint32_t size = _buffer.size() - _record - sizeof(size);
+            std::memcpy(_buffer.data() + _record, &size, sizeof(size));
+            _record = _buffer.size();
+        }
+    }
+
+    template <typename T>
+    void integer(T v)
+    {
+        _buffer.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    void string(std::string_view s)
+    {
+        integer(static_cast<std::uint32_t>(s.size()));
+        _buffer.append(s);
+    }
+
+    template <typename T>
+    void encode(const T& v)
+    {
+        integer(v);
+    }
+
+    void encode(const std::string& v)
+    {
+        string(v);
+    }
+
+    void encode(const std::vector<uint8_t>& v)
+    {
+        string({reinterpret_cast<const char*>(v.data()), v.size()});
+    }
+
+    void encode(const std::vector<std::string>& v)
+    {
+        integer(static_cast<std::uint32_t>(v.size()));
+        for (const auto& s : v)
+        {
+            string(s);
+        }
+    }
+
+    std::string _buffer;
+
+    /** @brief Where the last record starts. */
+    std::size_t _record = 0;
+};
+
+/** @class Writer
+ *  @brief Publishes images.  Used by PIM.
+ *
+ *  Object records are staged with update() and remove(), and written
+ *  together by publish().  Records are appended, and the image is
+ *  compacted once more than half of it is records no longer live.
+ */
+class Writer
+{
+  public:
+    /** @brief Create the file, replacing any left behind.
+     *
+     *  @param[in] path - The file to write.
+     */
+    explicit Writer(const std::string& path) : _path(path)
+    {
+        // The file is set up under another name, so readers never open
+        // it half made.
+        auto temp = path + ".new";
+        ::unlink(temp.c_str());
+        _file = detail::File(
+            ::open(temp.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644));
+        if (_file.get() < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), temp);
+        }
+        resize(initialCapacity);
+
+        auto& header = _mapping.header();
+        header.magic = detail::magic;
+        header.layout = detail::layout;
+        header.stream = std::random_device{}() |
+                        std::uint64_t(std::random_device{}()) << 32;
+
+        // Readers of an image left by an earlier PIM move to this one.
+        detail::File old(::open(path.c_str(), O_RDWR | O_CLOEXEC));
+        if (::rename(temp.c_str(), path.c_str()) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        retire(old);
+    }
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer(Writer&&) = delete;
+    Writer& operator=(Writer&&) = delete;
+
+    /** @brief Remove the file, so readers know there is no image. */
+    ~Writer()
+    {
+        _mapping.header().retired.store(1, std::memory_order_release);
+
+        // Leave the file alone if another writer has replaced it.
+        struct stat mine;
+        struct stat current;
+        if (::fstat(_file.get(), &mine) == 0 &&
+            ::stat(_path.c_str(), &current) == 0 &&
+            mine.st_ino == current.st_ino && mine.st_dev == current.st_dev)
+        {
+            ::unlink(_path.c_str());
+        }
+    }
+
+    /** @brief Stage an object's new record.
+     *
+     *  @param[in] path - The object path.
+     *  @param[in] record - The record, from an Encoder holding only this
+     *      object.
+     */
+    void update(std::string_view path, std::string_view record)
+    {
+        _pending.insert_or_assign(std::string(path), std::string(record));
+    }
+
+    /** @brief Stage removing an object.
+     *
+     *  @param[in] path - The object path.
+     */
+    void remove(std::string_view path)
+    {
+        _pending.insert_or_assign(std::string(path), std::nullopt);
+    }
+
+    /** @brief Write the staged records.
+     *
+     *  @param[in] version - The snapshot version of the image.
+     */
+    void publish(std::uint64_t version)
+    {
+        if (_pending.empty())
+        {
+            return;
+        }
+
+        auto* header = &_mapping.header();
+        auto sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Work out what the records being replaced leave behind.
+        std::size_t garbage = _garbage;
+        std::size_t added = 0;
+        for (const auto& [path, record] : _pending)
+        {
+            if (auto it = _records.find(path); it != _records.end())
+            {
+                garbage += it->second.second;
+            }
+            added += record ? record->size() : 0;
+        }
+
+        if (garbage * 2 > _size + added)
+        {
+            compact(added);
+        }
+        else
+        {
+            reserve(_size + added);
+            for (auto& [path, record] : _pending)
+            {
+                auto it = _records.find(path);
+                if (it != _records.end())
+                {
+                    // Clear the live flag that follows the size.
+                    _mapping.image()[it->second.first +
+                                     sizeof(std::uint32_t)] = 0;
+                    _garbage += it->second.second;
+                }
+                if (!record)
+                {
+                    if (it != _records.end())
+                    {
+                        _records.erase(it);
+                    }
+                    continue;
+                }
+                std::memcpy(_mapping.image() + _size, record->data(),
+                            record->size());
+                _records.insert_or_assign(
+                    std::move(path), std::pair{_size, record->size()});
+                _size += record->size();
+            }
+        }
+        _pending.clear();
+
+        header = &_mapping.header();
+        header->size.store(_size, std::memory_order_relaxed);
+        header->version.store(version, std::memory_order_relaxed);
+        header->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+  private:
+    static constexpr std::size_t initialCapacity = 64 * 1024;
+
+    static void retire(const detail::File& file)
+    {
+        struct stat st;
+        if (file.get() < 0 || ::fstat(file.get(), &st) < 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(detail::Header))
+        {
+            return;
+        }
+        detail::Mapping old(file.get(), sizeof(detail::Header),
+                            PROT_READ | PROT_WRITE);
+        if (old.header().magic == detail::magic)
+        {
+            old.header().retired.store(1, std::memory_order_release);
+        }
+    }
+
+    /** @brief Rewrite the image with only the live records and the
+     *      staged ones.
+     *
+     *  @param[in] added - The bytes of staged records.
+     */
+    void compact(std::size_t added)
+    {
+        std::string image;
+        image.reserve(_size - _garbage + added);
+        std::map<std::string, std::pair<std::size_t, std::size_t>,
+                 std::less<>>
+            records;
+        for (auto& [path, extent] : _records)
+        {
+            if (!_pending.contains(path))
+            {
+                records.emplace(path, std::pair{image.size(), extent.second});
+                image.append(_mapping.image() + extent.first, extent.second);
+            }
+        }
+        for (auto& [path, record] : _pending)
+        {
+            if (record)
+            {
+                records.emplace(path, std::pair{image.size(), record->size()});
+                image.append(*record);
+            }
+        }
+
+        reserve(image.size());
+        std::memcpy(_mapping.image(), image.data(), image.size());
+        _records = std::move(records);
+        _size = image.size();
+        _garbage = 0;
+    }
+
+    /** @brief Grow the file to hold an image of a size.  Readers notice
+     *      the larger capacity and map the file again.
+     */
+    void reserve(std::size_t size)
+    {
+        auto capacity =
+            _mapping.header().capacity.load(std::memory_order_relaxed);
+        if (size > capacity)
+        {
+            while (capacity < size)
+            {
+                capacity *= 2;
+            }
+            resize(capacity);
+        }
+    }
+
+    void resize(std::size_t capacity)
+    {
+        auto size = sizeof(detail::Header) + capacity;
+        if (::ftruncate(_file.get(), size) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                                    "ftruncate");
+        }
+        _mapping =
+            detail::Mapping(_file.get(), size, PROT_READ | PROT_WRITE);
+        _mapping.header().capacity.store(capacity, std::memory_order_relaxed);
+    }
+
+    std::string _path;
+    detail::File _file;
+    detail::Mapping _mapping;
+
+    /** @brief Where each object's live record is: offset and size. */
+    std::map<std::string, std::pair<std::size_t, std::size_t>, std::less<>>
+        _records;
+
+    /** @brief Staged records, or nullopt to remove the object. */
+    std::map<std::string, std::optional<std::string>, std::less<>> _pending;
+
+    /** @brief The bytes of image written. */
+    std::size_t _size = 0;
+
+    /** @brief The bytes of records no longer live. */
+    std::size_t _garbage = 0;
+};
+
+/** @class Reader
+ *  @brief Reads images published by PIM.
+ */
+class Reader
+{
+  public:
+    /** @brief Open the image.
+     *
+     *  @param[in] path - The file PIM writes.
+     *
+     *  @throws std::system_error if PIM is not publishing an image.
+     */
+    explicit Reader(const std::string& path = defaultPath) : _path(path)
+    {
+        open();
+    }
+
+    /** @brief Read a consistent copy of the image.
+     *
+     *  @param[in] since - Skip decoding if the image is still the one
+     *      last read, at this version.  An image from a restarted PIM is
+     *      always decoded, whatever its version.
+     *
+     *  @returns The objects, or nullopt if the image was unchanged.
+     *
+     *  @throws std::system_error if PIM restarted and is not publishing
+     *      an image yet.
+     */
+    std::optional<Objects> read(std::optional<std::uint64_t> since = {})
+    {
+        std::string image;
+        std::uint64_t stream = 0;
+        std::uint64_t version = 0;
+        bool unchanged = false;
+        while (true)
+        {
+            const auto& header = _mapping.header();
+            if (header.retired.load(std::memory_order_acquire))
+            {
+                open();
+                continue;
+            }
+
+            auto sequence = header.sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto capacity = header.capacity.load(std::memory_order_relaxed);
+            if (sizeof(detail::Header) + capacity > _mapping.size())
+            {
+                map();
+                continue;
+            }
+
+            stream = header.stream;
+            version = header.version.load(std::memory_order_relaxed);
+            auto size = header.size.load(std::memory_order_relaxed);
+            unchanged = since && *since == version && stream == _stream;
+            if (unchanged)
+            {
+                size = 0;
+            }
+            image.assign(_mapping.image(), std::min(size, capacity));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                break;
+            }
+        }
+
+        _stream = stream;
+        _version = version;
+        if (unchanged)
+        {
+            return std::nullopt;
+        }
+        return decode(image);
+    }
+
+    /** @brief The stream of the image last read, random for each PIM. */
+    std::uint64_t stream() const noexcept
+    {
+        return _stream;
+    }
+
+    /** @brief The version of the image last read. */
+    std::uint64_t version() const noexcept
+    {
+        return _version;
+    }
+
+  private:
+    void open()
+    {
+        _file = detail::File(::open(_path.c_str(), O_RDONLY | O_CLOEXEC));
+        if (_file.get() < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), _path);
+        }
+        map();
+
+        const auto& header = _mapping.header();
+        if (header.magic != detail::magic || header.layout != detail::layout)
+        {
+            throw std::runtime_error("Unsupported inventory image layout");
+        }
+    }
+
+    void map()
+    {
+        struct stat st;
+        if (::fstat(_file.get(), &st) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "fstat");
+        }
+        _mapping = detail::Mapping(_file.get(), st.st_size, PROT_READ);
+    }
+
+    /** @brief Reads values out of a copied image. */
+    struct Decoder
+    {
+        template <typename T>
+        T integer()
+        {
+            T v;
+            need(sizeof(v));
+            std::memcpy(&v, data.data(), sizeof(v));
+            data.remove_prefix(sizeof(v));
+            return v;
+        }
+
+        std::string string()
+        {
+            auto size = integer<std::uint32_t>();
+            need(size);
+            std::string s{data.substr(0, size)};
+            data.remove_prefix(size);
+            return s;
+        }
+
+        template <std::size_t I = 0>
+        Value value(std::size_t index)
+        {
+            if constexpr (I == std::variant_size_v<Value>)
+            {
+                throw std::runtime_error("Corrupt inventory image");
+            }
+            else if (index != I)
+            {
+                return value<I + 1>(index);
+            }
+            else
+            {
+                using T = std::variant_alternative_t<I, Value>;
+                if constexpr (std::is_same_v<T, std::string>)
+                {
+                    return string();
+                }
+                else if constexpr (std::is_same_v<T, std::vector<uint8_t>>)
+                {
+                    auto s = string();
+                    return std::vector<uint8_t>(s.begin(), s.end());
+                }
+                else if constexpr (std::is_same_v<T, std::vector<std::string>>)
+                {
+                    std::vector<std::string> v(integer<std::uint32_t>());
+                    for (auto& s : v)
+                    {
+                        s = string();
+                    }
+                    return v;
+                }
+                else
+                {
+                    return integer<T>();
+                }
+            }
+        }
+
+        void need(std::size_t size) const
+        {
+            if (data.size() < size)
+            {
+                throw std::runtime_error("Corrupt inventory image");
+            }
+        }
+
+        std::string_view data;
+    };
+
+    static Objects decode(std::string_view image)
+    {
+        Objects objects;
+        Decoder records{image};
+        while (!records.data.empty())
+        {
+            auto size = records.integer<std::uint32_t>();
+            records.need(size);
+            Decoder d{records.data.substr(0, size)};
+            records.data.remove_prefix(size);
+            if (!d.integer<std::uint8_t>())
+            {
+                // Replaced or removed since it was written.
+                continue;
+            }
+
+            auto& object = objects[d.string()];
+            for (auto i = d.integer<std::uint32_t>(); i; --i)
+            {
+                auto& interface = object[d.string()];
+                for (auto p = d.integer<std::uint32_t>(); p; --p)
+                {
+                    auto name = d.string();
+                    interface.emplace(std::move(name),
+                                      d.value(d.integer<std::uint8_t>()));
+                }
+            }
+        }
+        return objects;
+    }
+
+    std::string _path;
+    detail::File _file;
+    detail::Mapping _mapping;
+    std::uint64_t _stream = 0;
+    std::uint64_t _version = 0;
+};
+
+} // namespace view
+} // namespace inventory
+} // namespace phosphor
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace inventory
+{
+namespace manager
+{
+
+/** @brief An object's interfaces in a snapshot.
+ *
+ *  Each interface is shared by the versions it did not change in.
+ */
+using SnapshotObject = FlatMap<std::string, std::shared_ptr<const Interface>>;
+
+/** @class SnapshotIndex
+ *  @brief The objects of a snapshot, in path order.
+ *
+ *  Entries are kept in chunks of a few dozen, each held by a shared
+ *  pointer.  A new version copies the chunks it changes and shares the
+ *  others with the previous version, so publishing costs the chunk list
+ *  and the changed chunks rather than a copy of the whole inventory.
+ */
+class SnapshotIndex
+{
+  public:
+    using value_type =
+        std::pair<std::string, std::shared_ptr<const SnapshotObject>>;
+    using Chunk = std::vector<value_type>;
+
+    /** @class const_iterator
+     *  @brief Iterates the entries of every chunk in order.
+     */
+    class const_iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = SnapshotIndex::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const
+        {
+            return (**_chunk)[_entry];
+        }
+
+        pointer operator->() const
+        {
+            return &**this;
+        }
+
+        const_iterator& operator++()
+        {
+            // Chunks are never empty, so the next chunk has an entry.
+            if (++_entry == (*_chunk)->size())
+            {
+                ++_chunk;
+                _entry = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const const_iterator&,
+                               const const_iterator&) = default;
+
+      private:
+        friend class SnapshotIndex;
+
+        const_iterator(const std::shared_ptr<const Chunk>* chunk,
+                       std::size_t entry) : _chunk(chunk), _entry(entry)
+        {}
+
+        const std::shared_ptr<const Chunk>* _chunk = nullptr;
+        std::size_t _entry = 0;
+    };
+
+    const_iterator begin() const noexcept
+    {
+        return {_chunks.data(), 0};
+    }
+
+    const_iterator end() const noexcept
+    {
+        return {_chunks.data() + _chunks.size(), 0};
+    }
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /** @brief Look up an object.
+     *
+     *  @param[in] path - The object path, relative to the inventory root.
+     *
+     *  @returns The object, or nullptr if it does not exist.
+     */
+    const SnapshotObject* find(std::string_view path) const
+    {
+        if (_chunks.empty())
+        {
+            return nullptr;
+        }
+        const auto& chunk = *_chunks[locate(_chunks, path)];
+        auto it = lowerBound(chunk, path);
+        return it == chunk.end() || it->first != path ? nullptr
+                                                      : it->second.get();
+    }
+
+  private:
+    friend class SnapshotPublisher;
+
+    /** @brief The chunk that holds, or would hold, a path.
+     *
+     *  @param[in] chunks - The chunks, none of them empty.
+     *  @param[in] path - The object path.
+     */
+    template <typename Chunks>
+    static std::size_t locate(const Chunks& chunks, std::string_view path)
+    {
+        auto it = std::upper_bound(
+            chunks.begin(), chunks.end(), path,
+            [](std::string_view p, const auto& c) {
+                return p < c->front().first;
+            });
+        return it == chunks.begin() ? 0 : it - chunks.begin() - 1;
+    }
+
+    /** @brief The first entry of a chunk not ordered before a path. */
+    template <typename C>
+    static auto lowerBound(C& chunk, std::string_view path)
+        -> decltype(chunk.begin())
+    {
+        return std::lower_bound(chunk.begin(), chunk.end(), path,
+                                [](const value_type& e, std::string_view p) {
+                                    return e.first < p;
+                                });
+    }
+
+    std::vector<std::shared_ptr<const Chunk>> _chunks;
+    std::size_t _size = 0;
+};
+
+/** @struct Snapshot
+ *  @brief An immutable version of the inventory.
+ *
+ *  Objects and interfaces that did not change between versions are
+ *  shared by them.
+ */
+struct Snapshot
+{
+    using Objects = SnapshotIndex;
+
+    /** @brief Look up an object.
+     *
+     *  @param[in] path - The object path, relative to the inventory root.
+     *
+     *  @returns The object, or nullptr if it does not exist.
+     */
+    const SnapshotObject* find(std::string_view path) const
+    {
+        return objects.find(path);
+    }
+
+    /** @brief The version, counting up from 1. */
+    std::uint64_t version = 0;
+
+    /** @brief The objects, by path relative to the inventory root. */
+    Objects objects;
+};
+
+/** @class SnapshotPublisher
+ *  @brief Publishes inventory snapshots copy-on-write.
+ *
+ *  The writer stages changes and publishes them as a new version.  Any
+ *  thread can take the current version with current(), and keeps it
+ *  valid for as long as it holds it.  A version is freed once the last
+ *  reader lets go of it.
+ */
+class SnapshotPublisher
+{
+  public:
+    /** @brief Chunks are split in two when they grow past this size. */
+    static constexpr std::size_t maxChunk = 128;
+
+    SnapshotPublisher() : _current(std::make_shared<const Snapshot>()) {}
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+    SnapshotPublisher(SnapshotPublisher&&) = delete;
+    SnapshotPublisher& operator=(SnapshotPublisher&&) = delete;
+    ~SnapshotPublisher() = default;
+
+    /** @brief The latest published version. */
+    std::shared_ptr<const Snapshot> current() const noexcept
+    {
+        return _current.load(std::memory_order_acquire);
+    }
+
+    /** @brief Stage the new state of an object.
+     *
+     *  @param[in] path - The object path, relative to the inventory root.
+     *  @param[in] object - The object's interfaces and properties.
+     */
+    void stage(std::string_view path, SnapshotObject&& object)
+    {
+        auto next = std::make_shared<const SnapshotObject>(std::move(object));
+        _changed = true;
+        if (_chunks.empty())
+        {
+            _chunks.push_back(std::make_shared<Chunk>());
+            _chunks.back()->emplace_back(path, std::move(next));
+            _shared.push_back(false);
+            ++_size;
+            return;
+        }
+
+        auto i = SnapshotIndex::locate(_chunks, path);
+        auto& chunk = writable(i);
+        auto it = SnapshotIndex::lowerBound(chunk, path);
+        if (it != chunk.end() && it->first == path)
+        {
+            it->second = std::move(next);
+            return;
+        }
+        chunk.emplace(it, path, std::move(next));
+        ++_size;
+
+        if (chunk.size() > maxChunk)
+        {
+            auto half = chunk.begin() + chunk.size() / 2;
+            auto tail = std::make_shared<Chunk>(
+                std::make_move_iterator(half),
+                std::make_move_iterator(chunk.end()));
+            chunk.erase(half, chunk.end());
+            _chunks.insert(_chunks.begin() + i + 1, std::move(tail));
+            _shared.insert(_shared.begin() + i + 1, false);
+        }
+    }
+
+    /** @brief Stage removing an object.
+     *
+     *  @param[in] path - The object path, relative to the inventory root.
+     */
+    void remove(std::string_view path)
+    {
+        if (_chunks.empty())
+        {
+            return;
+        }
+
+        auto i = SnapshotIndex::locate(_chunks, path);
+        auto it = SnapshotIndex::lowerBound(*_chunks[i], path);
+        if (it == _chunks[i]->end() || it->first != path)
+        {
+            return;
+        }
+
+        auto offset = it - _chunks[i]->begin();
+        auto& chunk = writable(i);
+        chunk.erase(chunk.begin() + offset);
+        --_size;
+        if (chunk.empty())
+        {
+            _chunks.erase(_chunks.begin() + i);
+            _shared.erase(_shared.begin() + i);
+        }
+        _changed = true;
+    }
+
+    /** @brief Publish the staged changes as a new version.
+     *
+     *  Nothing is published if nothing was staged.
+     */
+    void publish()
+    {
+        if (!_changed)
+        {
+            return;
+        }
+
+        // The chunks become part of the version, so later changes copy
+        // them first.
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->version = ++_version;
+        snapshot->objects._chunks.assign(_chunks.begin(), _chunks.end());
+        snapshot->objects._size = _size;
+        std::fill(_shared.begin(), _shared.end(), true);
+        _current.store(std::move(snapshot), std::memory_order_release);
+        _changed = false;
+    }
+
+  private:
+    using Chunk = SnapshotIndex::Chunk;
+
+    /** @brief A chunk the writer may change, copied if it is shared
+     *      with a published version.
+     */
+    Chunk& writable(std::size_t i)
+    {
+        if (_shared[i])
+        {
+            _chunks[i] = std::make_shared<Chunk>(*_chunks[i]);
+            _shared[i] = false;
+        }
+        return *_chunks[i];
+    }
+
+    /** @brief The writer's copy of the next version's chunks. */
+    std::vector<std::shared_ptr<Chunk>> _chunks;
+
+    /** @brief Whether each chunk is part of a published version. */
+    std::vector<bool> _shared;
+
+    /** @brief The number of objects in the next version. */
+    std::size_t _size = 0;
+
+    /** @brief Whether the next version differs from the current one. */
+    bool _changed = false;
+
+    /** @brief The last version number used. */
+    std::uint64_t _version = 0;
+
+    std::atomic<std::shared_ptr<const Snapshot>> _current;
+};
+
+} // namespace manager
+} // namespace inventory
+} // namespace phosphor
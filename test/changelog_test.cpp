@@ -0,0 +1,51 @@
+#include "../changelog.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+
+TEST(ChangeLogTest, TestSince)
+{
+    ChangeLog log(16);
+    log.record(1, "/a", "xyz.foo");
+    log.record(1, "/b", "xyz.foo");
+    log.record(2, "/a", "xyz.bar");
+    log.record(3, "/a", "xyz.foo");
+
+    auto all = log.since(0);
+    ASSERT_TRUE(all);
+    EXPECT_EQ(*all, (ChangeLog::Changes{{"/a", {"xyz.bar", "xyz.foo"}},
+                                        {"/b", {"xyz.foo"}}}));
+
+    auto some = log.since(2);
+    ASSERT_TRUE(some);
+    EXPECT_EQ(*some, (ChangeLog::Changes{{"/a", {"xyz.foo"}}}));
+
+    auto none = log.since(3);
+    ASSERT_TRUE(none);
+    EXPECT_TRUE(none->empty());
+}
+
+TEST(ChangeLogTest, TestDropped)
+{
+    ChangeLog log(2);
+    log.record(1, "/a", "xyz.foo");
+    log.record(2, "/b", "xyz.foo");
+    log.record(2, "/c", "xyz.foo");
+    log.record(3, "/d", "xyz.foo");
+
+    // Generation 2 was partly dropped, so only callers that have it can
+    // catch up.
+    EXPECT_FALSE(log.since(0));
+    EXPECT_FALSE(log.since(1));
+    auto changes = log.since(2);
+    ASSERT_TRUE(changes);
+    EXPECT_EQ(*changes, (ChangeLog::Changes{{"/d", {"xyz.foo"}}}));
+}
+
+TEST(ChangeLogTest, TestStream)
+{
+    ChangeLog a(1);
+    ChangeLog b(1);
+    EXPECT_NE(a.stream(), b.stream());
+}
@@ -0,0 +1,138 @@
+#include "../compact.hpp"
+
+#include <malloc.h>
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/slot.hpp>
+#include <sdbusplus/vtable.hpp>
+#include <systemd/sd-bus.h>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+constexpr auto objects = 10000;
+constexpr auto root = "/xyz/openbmc_project/inventory";
+constexpr auto itemIface = "xyz.openbmc_project.Inventory.Item";
+
+const std::array<compact::Property, 2> itemProperties{{
+    {"PrettyName", std::string{}, {}},
+    {"Present", bool{}, {}},
+}};
+const sdbusplus::vtable_t itemVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::property("PrettyName", "s", compact::Values::get,
+                                compact::Values::set,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::property("Present", "b", compact::Values::get,
+                                compact::Values::set,
+                                sdbusplus::vtable::property_::emits_change),
+    sdbusplus::vtable::end(),
+};
+const compact::InterfaceInfo item{itemIface, itemProperties, itemVtable,
+                                  nullptr};
+
+std::string objectPath(int i)
+{
+    return root + "/system/chassis/board"s + std::to_string(i);
+}
+
+/** @brief A bus that is never connected, to register objects on. */
+sdbusplus::bus_t privateBus()
+{
+    sd_bus* b = nullptr;
+    sd_bus_new(&b);
+    return sdbusplus::bus_t{b, std::false_type{}};
+}
+
+/** @brief Report the heap used and the time taken by a setup. */
+template <typename F>
+void report(const char* name, F&& setup)
+{
+    auto before = mallinfo2().uordblks;
+    auto start = std::chrono::steady_clock::now();
+    auto state = setup();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    auto used = mallinfo2().uordblks - before;
+
+    std::cout << name << ": " << used / objects << " bytes per object, "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                     .count()
+              << " ms\n";
+}
+
+/** @brief Register a vtable per object, as the sdbusplus bindings do. */
+auto perObject()
+{
+    struct State
+    {
+        sdbusplus::bus_t bus = privateBus();
+        std::map<std::string, std::unique_ptr<compact::Values>> objects;
+        std::vector<sdbusplus::slot_t> slots;
+    };
+    auto state = std::make_unique<State>();
+    for (auto i = 0; i < objects; ++i)
+    {
+        auto values = std::make_unique<compact::Values>(item);
+        auto path = objectPath(i);
+        sd_bus_slot* slot = nullptr;
+        sd_bus_add_object_vtable(state->bus.get(), &slot, path.c_str(),
+                                 itemIface, itemVtable, values.get());
+        state->slots.emplace_back(slot);
+        state->objects.emplace(std::move(path), std::move(values));
+    }
+    return state;
+}
+
+/** @brief Register a single fallback vtable for every object. */
+auto fallback()
+{
+    struct State
+    {
+        sdbusplus::bus_t bus = privateBus();
+        std::map<std::string, std::unique_ptr<compact::Values>, std::less<>>
+            objects;
+        std::unique_ptr<compact::Server> server;
+    };
+    auto state = std::make_unique<State>();
+    const compact::InterfaceInfo* interfaces[] = {&item};
+    state->server = std::make_unique<compact::Server>(
+        state->bus, root, interfaces,
+        [&objects = state->objects](std::string_view path,
+                                    std::size_t) -> compact::Values* {
+            auto it = objects.find(path);
+            return it == objects.end() ? nullptr : it->second.get();
+        },
+        [&objects = state->objects](std::string_view) {
+            std::vector<std::string> paths;
+            for (const auto& [path, values] : objects)
+            {
+                paths.push_back(path);
+            }
+            return paths;
+        });
+    for (auto i = 0; i < objects; ++i)
+    {
+        state->objects.emplace(objectPath(i),
+                               std::make_unique<compact::Values>(item));
+    }
+    return state;
+}
+} // namespace
+
+int main()
+{
+    std::cout << objects << " objects with " << itemIface << "\n";
+    report("vtable per object", perObject);
+    report("fallback vtable", fallback);
+    return 0;
+}
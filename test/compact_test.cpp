@@ -0,0 +1,55 @@
+#include "../compact.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+constexpr std::array<const char*, 2> states{"xyz.Fan.State.On",
+                                            "xyz.Fan.State.Off"};
+const std::array<compact::Property, 3> properties{{
+    {"Present", true, {}},
+    {"Speed", size_t{}, {}},
+    {"State", "xyz.Fan.State.Off"s, states},
+}};
+const compact::InterfaceInfo fan{"xyz.Fan", properties, nullptr, nullptr};
+} // namespace
+
+TEST(CompactTest, TestDefaults)
+{
+    compact::Values values(fan);
+    EXPECT_EQ(values.getPropertyByName("Present"), InterfaceVariantType(true));
+    EXPECT_EQ(values.getPropertyByName("State"),
+              InterfaceVariantType("xyz.Fan.State.Off"s));
+
+    // Unknown properties read as a default constructed value.
+    EXPECT_EQ(values.position("Model"), properties.size());
+    EXPECT_EQ(values.getPropertyByName("Model"), InterfaceVariantType());
+}
+
+TEST(CompactTest, TestSet)
+{
+    sdbusplus::bus_t bus;
+    compact::Binding<fan> binding(bus, "/fan",
+                                  {{"Speed", size_t{1000}},
+                                   {"Model", "x"s}},
+                                  true);
+    EXPECT_EQ(binding.getPropertyByName("Speed"),
+              InterfaceVariantType(size_t{1000}));
+
+    EXPECT_TRUE(binding.setPropertyByName("State", "xyz.Fan.State.On"s));
+    EXPECT_EQ(binding.getPropertyByName("State"),
+              InterfaceVariantType("xyz.Fan.State.On"s));
+
+    // Values of the wrong type, and unknown enumeration values, are
+    // ignored.
+    EXPECT_FALSE(binding.setPropertyByName("Speed", int64_t{5}));
+    EXPECT_FALSE(binding.setPropertyByName("State", "xyz.Fan.State.Up"s));
+    EXPECT_FALSE(binding.setPropertyByName("Model", "y"s));
+    EXPECT_EQ(binding.getPropertyByName("Speed"),
+              InterfaceVariantType(size_t{1000}));
+    EXPECT_EQ(binding.getPropertyByName("State"),
+              InterfaceVariantType("xyz.Fan.State.On"s));
+}
@@ -0,0 +1,100 @@
+#include "../coroutine.hpp"
+
+#include <coroutine>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+
+namespace
+{
+/** @brief An awaitable resumed by the test rather than by a reply. */
+struct Pending
+{
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        waiting.push_back(h);
+    }
+
+    void await_resume() const noexcept {}
+
+    std::vector<std::coroutine_handle<>>& waiting;
+};
+
+Task<int> value(int v)
+{
+    co_return v;
+}
+
+Task<int> sum(int a, int b)
+{
+    co_return co_await value(a) + co_await value(b);
+}
+
+Task<bool> fail()
+{
+    throw std::runtime_error("failed");
+    co_return false;
+}
+
+Task<int> waitThenAdd(std::vector<std::coroutine_handle<>>& waiting, int v)
+{
+    co_await Pending{waiting};
+    co_return v + 1;
+}
+} // namespace
+
+TEST(CoroutineTest, TestTaskChain)
+{
+    int result = 0;
+    auto run = [&]() -> Task<> { result = co_await sum(2, 3); };
+
+    spawn(run());
+    EXPECT_EQ(result, 5);
+}
+
+TEST(CoroutineTest, TestTaskException)
+{
+    auto caught = false;
+    auto run = [&]() -> Task<> {
+        try
+        {
+            co_await fail();
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+    };
+
+    spawn(run());
+    EXPECT_TRUE(caught);
+}
+
+TEST(CoroutineTest, TestSpawnSuspended)
+{
+    std::vector<std::coroutine_handle<>> waiting;
+    std::vector<int> results;
+    auto run = [&](int v) -> Task<> {
+        results.push_back(co_await waitThenAdd(waiting, v));
+    };
+
+    // Both tasks are in flight at once, and finish in the order they
+    // are resumed.
+    spawn(run(1));
+    spawn(run(10));
+    ASSERT_EQ(waiting.size(), 2);
+    EXPECT_TRUE(results.empty());
+
+    waiting[1].resume();
+    EXPECT_EQ(results, std::vector<int>{11});
+    waiting[0].resume();
+    EXPECT_EQ(results, (std::vector<int>{11, 2}));
+}
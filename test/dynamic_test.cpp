@@ -0,0 +1,103 @@
+#include "../dynamic.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+const auto description = R"({
+    "interfaces": [
+        {
+            "name": "xyz.Fan",
+            "properties": [
+                {"name": "Present", "signature": "b", "default": true},
+                {"name": "Speed", "signature": "t"},
+                {
+                    "name": "State",
+                    "signature": "s",
+                    "default": "xyz.Fan.State.Off",
+                    "enumeration": ["xyz.Fan.State.On", "xyz.Fan.State.Off"]
+                },
+                {"name": "Path", "signature": "o"},
+                {"name": "Serial", "signature": "s", "flags": ["readonly"]},
+                {"name": "Ratio", "signature": "d", "default": "NaN"},
+                {
+                    "name": "Mode",
+                    "signature": "s",
+                    "default": "xyz.Other.Mode.Fast",
+                    "fixed": true
+                }
+            ]
+        },
+        {"name": "xyz.Cpu", "properties": []},
+        {"name": "xyz.Board"}
+    ]
+})"_json;
+} // namespace
+
+TEST(DynamicTest, TestRegistry)
+{
+    compact::Registry registry(description);
+
+    // Interfaces are sorted by name, as interface IDs require.
+    auto interfaces = registry.interfaces();
+    ASSERT_EQ(interfaces.size(), 3);
+    EXPECT_STREQ(interfaces[0]->name, "xyz.Board");
+    EXPECT_STREQ(interfaces[1]->name, "xyz.Cpu");
+    EXPECT_STREQ(interfaces[2]->name, "xyz.Fan");
+    EXPECT_TRUE(interfaces[0]->properties.empty());
+
+    // Properties of unsupported types are served with their default, or
+    // left out if they have none.
+    const auto& fan = *interfaces[2];
+    ASSERT_EQ(fan.properties.size(), 4);
+    EXPECT_STREQ(fan.properties[3].name, "Serial");
+    EXPECT_EQ(fan.properties[0].init, InterfaceVariantType(true));
+    EXPECT_EQ(fan.properties[1].init, InterfaceVariantType(size_t{}));
+    ASSERT_EQ(fan.properties[2].enumeration.size(), 2);
+    EXPECT_STREQ(fan.properties[2].enumeration[0], "xyz.Fan.State.On");
+    ASSERT_EQ(fan.fixed.size(), 2);
+    EXPECT_STREQ(fan.fixed[0].name, "Ratio");
+    EXPECT_STREQ(fan.fixed[0].signature, "d");
+    EXPECT_STREQ(fan.fixed[0].value, R"("NaN")");
+    EXPECT_STREQ(fan.fixed[1].name, "Mode");
+
+    // The vtable has a start, an entry per property and fixed property,
+    // and an end.
+    EXPECT_EQ(fan.vtable[0].type, _SD_BUS_VTABLE_START);
+    for (std::size_t i = 1; i <= fan.properties.size(); ++i)
+    {
+        EXPECT_STREQ(fan.vtable[i].x.property.member,
+                     fan.properties[i - 1].name);
+    }
+    EXPECT_EQ(fan.vtable[1].type, _SD_BUS_VTABLE_WRITABLE_PROPERTY);
+    EXPECT_EQ(fan.vtable[4].type, _SD_BUS_VTABLE_PROPERTY);
+    EXPECT_STREQ(fan.vtable[5].x.property.member, "Ratio");
+    EXPECT_EQ(fan.vtable[5].type, _SD_BUS_VTABLE_PROPERTY);
+    EXPECT_EQ(fan.vtable[5].x.property.get, compact::Values::getFixed);
+    EXPECT_EQ(fan.vtable[7].type, _SD_BUS_VTABLE_END);
+}
+
+TEST(DynamicTest, TestDynamic)
+{
+    compact::Registry registry(description);
+    const auto& fan = *registry.interfaces()[2];
+
+    auto holder = InterfaceHolder::make<compact::Dynamic>(
+        fan, Interface{{"Speed", size_t{1000}},
+                       {"State", "xyz.Fan.State.Up"s},
+                       {"Model", "x"s}});
+    auto& values = fan.values(holder);
+    EXPECT_EQ(&values.info(), &fan);
+
+    // Unknown properties and values are ignored.
+    auto properties = holder.get<compact::Dynamic>().properties();
+    EXPECT_EQ(properties.size(), 4);
+    EXPECT_EQ(properties.find("Speed")->second,
+              InterfaceVariantType(size_t{1000}));
+    EXPECT_EQ(properties.find("State")->second,
+              InterfaceVariantType("xyz.Fan.State.Off"s));
+    EXPECT_EQ(properties.find("Model"), properties.end());
+}
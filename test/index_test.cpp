@@ -0,0 +1,48 @@
+#include "../index.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+
+TEST(IndexTest, TestPaths)
+{
+    InterfaceIndex index(std::vector<std::string>{});
+    index.add("/b");
+    index.add("/a");
+    index.add("/a");
+    EXPECT_EQ(index.paths(), (InterfaceIndex::Paths{"/a", "/b"}));
+
+    index.remove("/a");
+    index.remove("/c");
+    EXPECT_EQ(index.paths(), (InterfaceIndex::Paths{"/b"}));
+}
+
+TEST(IndexTest, TestValues)
+{
+    InterfaceIndex index({"Present", "PrettyName"});
+    ASSERT_EQ(index.properties(), 2);
+    EXPECT_EQ(index.property(1), "PrettyName");
+    EXPECT_EQ(index.find("Model", true), nullptr);
+
+    index.add("/a");
+    index.set(0, "/a", true);
+    index.add("/b");
+    index.set(0, "/b", true);
+    index.set(1, "/b", std::string("dimm"));
+    EXPECT_EQ(*index.find("Present", true),
+              (InterfaceIndex::Paths{"/a", "/b"}));
+    EXPECT_TRUE(index.find("Present", false)->empty());
+    EXPECT_EQ(*index.find("PrettyName", std::string("dimm")),
+              (InterfaceIndex::Paths{"/b"}));
+
+    // A changed value moves the object.
+    index.set(0, "/a", false);
+    EXPECT_EQ(*index.find("Present", true), (InterfaceIndex::Paths{"/b"}));
+    EXPECT_EQ(*index.find("Present", false), (InterfaceIndex::Paths{"/a"}));
+
+    // Removing the object drops all of its values.
+    index.remove("/b");
+    EXPECT_TRUE(index.find("Present", true)->empty());
+    EXPECT_TRUE(index.find("PrettyName", std::string("dimm"))->empty());
+    EXPECT_EQ(*index.find("Present", false), (InterfaceIndex::Paths{"/a"}));
+}
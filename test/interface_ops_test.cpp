@@ -37,6 +37,7 @@ struct MockInterface
                  void(const char*, const InterfaceVariant& i, bool));
     MOCK_METHOD1(constructWithoutProperties, void(const char*));
     MOCK_METHOD3(setPropertyByName, void(std::string, FakeVariantType, bool));
+    MOCK_METHOD1(getPropertyByName, FakeVariantType(std::string));
 
     MOCK_METHOD2(serializeTwoArgs,
                  void(const std::string&, const std::string&));
@@ -73,6 +74,11 @@ struct DummyInterfaceWithProperties
     {
         g_currentMock->setPropertyByName(name, val, skipSignal);
     }
+
+    PropertiesVariant getPropertyByName(const std::string& name)
+    {
+        return g_currentMock->getPropertyByName(name);
+    }
 };
 
 struct SerialForwarder
@@ -101,6 +107,56 @@ struct SerialForwarder
     }
 };
 
+struct CountedInterface
+{
+    explicit CountedInterface(int& count) : count(count)
+    {
+        ++count;
+    }
+    ~CountedInterface()
+    {
+        --count;
+    }
+    CountedInterface(const CountedInterface&) = delete;
+    CountedInterface& operator=(const CountedInterface&) = delete;
+    CountedInterface(CountedInterface&&) = delete;
+    CountedInterface& operator=(CountedInterface&&) = delete;
+
+    int& count;
+};
+
+TEST(InterfaceOpsTest, TestHolderOwnership)
+{
+    int count = 0;
+    {
+        auto h1 = InterfaceHolder::make<CountedInterface>(count);
+        EXPECT_EQ(count, 1);
+
+        auto h2 = std::move(h1);
+        EXPECT_EQ(count, 1);
+        EXPECT_FALSE(h1.holds<CountedInterface>());
+        EXPECT_TRUE(h2.holds<CountedInterface>());
+        EXPECT_EQ(&h2.get<CountedInterface>().count, &count);
+
+        h1 = InterfaceHolder::make<CountedInterface>(count);
+        EXPECT_EQ(count, 2);
+        h1 = std::move(h2);
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_EQ(count, 0);
+}
+
+TEST(InterfaceOpsTest, TestHolderTypeMismatch)
+{
+    int count = 0;
+    auto h = InterfaceHolder::make<CountedInterface>(count);
+
+    EXPECT_FALSE(h.holds<DummyInterfaceWithProperties>());
+    EXPECT_THROW(h.get<DummyInterfaceWithProperties>(), std::runtime_error);
+    EXPECT_THROW(InterfaceHolder().get<CountedInterface>(),
+                 std::runtime_error);
+}
+
 TEST(InterfaceOpsTest, TestHasPropertiesNoProperties)
 {
     EXPECT_FALSE(HasProperties<DummyInterfaceWithoutProperties>::value);
@@ -121,11 +177,10 @@ TEST(InterfaceOpsTest, TestMakePropertylessInterfaceWithoutArguments)
     EXPECT_CALL(mock, constructWithProperties(_, _, _)).Times(0);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    EXPECT_NO_THROW(
-        std::any_cast<std::shared_ptr<DummyInterfaceWithoutProperties>>(r));
+    EXPECT_TRUE(r.holds<DummyInterfaceWithoutProperties>());
 }
 
 TEST(InterfaceOpsTest, TestMakePropertylessInterfaceWithOneArgument)
@@ -138,11 +193,10 @@ TEST(InterfaceOpsTest, TestMakePropertylessInterfaceWithOneArgument)
     EXPECT_CALL(mock, constructWithProperties(_, _, _)).Times(0);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    EXPECT_NO_THROW(
-        std::any_cast<std::shared_ptr<DummyInterfaceWithoutProperties>>(r));
+    EXPECT_TRUE(r.holds<DummyInterfaceWithoutProperties>());
 }
 
 TEST(InterfaceOpsTest, TestMakeInterfaceWithWithoutArguments)
@@ -155,11 +209,10 @@ TEST(InterfaceOpsTest, TestMakeInterfaceWithWithoutArguments)
     EXPECT_CALL(mock, constructWithProperties("bar", _, _)).Times(1);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "bar", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "bar", Interface{i}, false);
 
-    EXPECT_NO_THROW(
-        std::any_cast<std::shared_ptr<DummyInterfaceWithProperties>>(r));
+    EXPECT_TRUE(r.holds<DummyInterfaceWithProperties>());
 }
 
 TEST(InterfaceOpsTest, TestMakeInterfaceWithOneArgument)
@@ -172,11 +225,10 @@ TEST(InterfaceOpsTest, TestMakeInterfaceWithOneArgument)
     EXPECT_CALL(mock, constructWithProperties("foo", _, _)).Times(1);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    EXPECT_NO_THROW(
-        std::any_cast<std::shared_ptr<DummyInterfaceWithProperties>>(r));
+    EXPECT_TRUE(r.holds<DummyInterfaceWithProperties>());
 }
 
 TEST(InterfaceOpsTest, TestAssignPropertylessInterfaceWithoutArguments)
@@ -188,10 +240,11 @@ TEST(InterfaceOpsTest, TestAssignPropertylessInterfaceWithoutArguments)
     EXPECT_CALL(mock, setPropertyByName(_, _, _)).Times(0);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    AssignInterface<DummyInterfaceWithoutProperties>::op(i, r, false);
+    AssignInterface<DummyInterfaceWithoutProperties>::op(std::move(i), r,
+                                                         false);
 }
 
 TEST(InterfaceOpsTest, TestAssignPropertylessInterfaceWithOneArgument)
@@ -203,10 +256,11 @@ TEST(InterfaceOpsTest, TestAssignPropertylessInterfaceWithOneArgument)
     EXPECT_CALL(mock, setPropertyByName(_, _, _)).Times(0);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    AssignInterface<DummyInterfaceWithoutProperties>::op(i, r, false);
+    AssignInterface<DummyInterfaceWithoutProperties>::op(std::move(i), r,
+                                                         false);
 }
 
 TEST(InterfaceOpsTest, TestAssignInterfaceWithoutArguments)
@@ -218,10 +272,10 @@ TEST(InterfaceOpsTest, TestAssignInterfaceWithoutArguments)
     EXPECT_CALL(mock, setPropertyByName(_, _, _)).Times(0);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
-    AssignInterface<DummyInterfaceWithProperties>::op(i, r, false);
+    AssignInterface<DummyInterfaceWithProperties>::op(std::move(i), r, false);
 }
 
 TEST(InterfaceOpsTest, TestAssignInterfaceWithOneArgument)
@@ -230,13 +284,37 @@ TEST(InterfaceOpsTest, TestAssignInterfaceWithOneArgument)
     Interface i{{"foo"s, static_cast<int64_t>(1ll)}};
     sdbusplus::SdBusMock interface;
 
+    EXPECT_CALL(mock, getPropertyByName("foo"s)).WillOnce(Return(0));
     EXPECT_CALL(mock, setPropertyByName("foo"s, 1ll, _)).Times(1);
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "bar", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "bar", Interface{i}, false);
+
+    auto changed = AssignInterface<DummyInterfaceWithProperties>::op(
+        std::move(i), r, false);
+    EXPECT_EQ(changed, std::vector<std::string>{"foo"s});
+}
+
+TEST(InterfaceOpsTest, TestAssignInterfaceUnchanged)
+{
+    MockInterface mock;
+    Interface i{{"foo"s, static_cast<int64_t>(1ll)},
+                {"bar"s, static_cast<int64_t>(2ll)}};
+    sdbusplus::SdBusMock interface;
+
+    EXPECT_CALL(mock, getPropertyByName("foo"s)).WillOnce(Return(1));
+    EXPECT_CALL(mock, getPropertyByName("bar"s)).WillOnce(Return(1));
+    EXPECT_CALL(mock, setPropertyByName("foo"s, _, _)).Times(0);
+    EXPECT_CALL(mock, setPropertyByName("bar"s, 2ll, _)).Times(1);
+
+    auto b = sdbusplus::get_mocked_new(&interface);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "bar", Interface{i}, false);
 
-    AssignInterface<DummyInterfaceWithProperties>::op(i, r, false);
+    auto changed = AssignInterface<DummyInterfaceWithProperties>::op(
+        std::move(i), r, false);
+    EXPECT_EQ(changed, std::vector<std::string>{"bar"s});
 }
 
 TEST(InterfaceOpsTest, TestSerializePropertylessInterfaceWithoutArguments)
@@ -246,8 +324,8 @@ TEST(InterfaceOpsTest, TestSerializePropertylessInterfaceWithoutArguments)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, serializeTwoArgs("/foo"s, "bar"s)).Times(1);
 
@@ -262,8 +340,8 @@ TEST(InterfaceOpsTest, TestSerializePropertylessInterfaceWithOneArgument)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, serializeTwoArgs("/foo"s, "bar"s)).Times(1);
 
@@ -278,8 +356,8 @@ TEST(InterfaceOpsTest, TestSerializeInterfaceWithNoArguments)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, serializeThreeArgs("/foo"s, "bar"s, _)).Times(1);
 
@@ -294,8 +372,8 @@ TEST(InterfaceOpsTest, TestSerializeInterfaceWithOneArgument)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, serializeThreeArgs("/foo"s, "bar"s, _)).Times(1);
 
@@ -310,8 +388,8 @@ TEST(InterfaceOpsTest, TestDeserializePropertylessInterfaceWithoutArguments)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, deserializeNoop()).Times(1);
 
@@ -326,8 +404,8 @@ TEST(InterfaceOpsTest, TestDeserializePropertylessInterfaceWithOneArgument)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithoutProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithoutProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, deserializeNoop()).Times(1);
 
@@ -342,8 +420,8 @@ TEST(InterfaceOpsTest, TestDeserializeInterfaceWithNoArguments)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, deserializeThreeArgs("/foo"s, "bar"s, _)).Times(1);
 
@@ -358,8 +436,8 @@ TEST(InterfaceOpsTest, TestDeserializeInterfaceWithOneArgument)
     sdbusplus::SdBusMock interface;
 
     auto b = sdbusplus::get_mocked_new(&interface);
-    auto r =
-        MakeInterface<DummyInterfaceWithProperties>::op(b, "foo", i, false);
+    auto r = MakeInterface<DummyInterfaceWithProperties>::op(
+        b, "foo", Interface{i}, false);
 
     EXPECT_CALL(mock, deserializeThreeArgs("/foo"s, "bar"s, _)).Times(1);
 
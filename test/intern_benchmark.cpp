@@ -0,0 +1,131 @@
+#include "../intern.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+constexpr auto objects = 10000;
+constexpr auto root = "/xyz/openbmc_project/inventory";
+
+/** @brief Property values repeated across objects. */
+const std::array<std::pair<const char*, const char*>, 4> asset{{
+    {"Manufacturer", "International Business Machines Corp."},
+    {"Model", "Power Supply Unit 1400W Titanium"},
+    {"PartNumber", "01KL456-PSU-REV-B"},
+    {"SubModel", "Redundant Hot Swap Module"},
+}};
+
+std::string objectPath(int i)
+{
+    return root + "/system/chassis/motherboard/powersupply"s +
+           std::to_string(i);
+}
+
+/** @brief The resident set size, in bytes. */
+long rss()
+{
+    long pages = 0;
+    long resident = 0;
+    std::ifstream{"/proc/self/statm"} >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/** @brief Report the memory a setup takes, measured in a child process
+ *      so each setup starts from the same heap.
+ */
+template <typename F>
+void report(const char* name, F&& setup)
+{
+    std::cout.flush();
+    auto pid = fork();
+    if (pid == 0)
+    {
+        auto before = rss();
+        auto state = setup();
+        auto used = rss() - before;
+        std::cout << name << ": " << used / 1024 << " KiB RSS, "
+                  << used / objects << " bytes per object\n";
+        std::cout.flush();
+        _exit(0);
+    }
+    waitpid(pid, nullptr, 0);
+}
+
+/** @brief Paths and values as strings, as kept without interning.
+ *
+ *  Each path is the key of an object, an associations key and a handled
+ *  association, as in the manager and association manager.
+ */
+auto strings()
+{
+    struct State
+    {
+        std::map<std::string, std::vector<std::pair<std::string, std::string>>>
+            refs;
+        std::map<std::string, int> associations;
+        std::vector<std::string> handled;
+    };
+    auto state = std::make_unique<State>();
+    for (auto i = 0; i < objects; ++i)
+    {
+        auto path = objectPath(i);
+        auto& props = state->refs[path];
+        for (const auto& [name, value] : asset)
+        {
+            props.emplace_back(name, value);
+        }
+        state->associations.emplace(path, i);
+        state->handled.push_back(path);
+    }
+    return state;
+}
+
+/** @brief Association paths and values as interned handles.  Object
+ *      keys stay strings, as in the manager.
+ */
+auto interned()
+{
+    struct State
+    {
+        std::map<std::string, std::vector<std::pair<Interned, Interned>>>
+            refs;
+        std::map<Interned, int> associations;
+        std::vector<Interned> handled;
+    };
+    auto state = std::make_unique<State>();
+    for (auto i = 0; i < objects; ++i)
+    {
+        auto& props = state->refs[objectPath(i)];
+        Interned path(objectPath(i));
+        for (const auto& [name, value] : asset)
+        {
+            props.emplace_back(Interned(name), Interned(value));
+        }
+        state->associations.emplace(path, i);
+        state->handled.push_back(path);
+    }
+    return state;
+}
+} // namespace
+
+int main()
+{
+    std::cout << objects << " objects with " << asset.size()
+              << " asset properties\n";
+    report("strings", strings);
+    report("interned", interned);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "../intern.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+TEST(InternTest, TestHandles)
+{
+    auto count = Interned::count();
+    Interned a("/xyz/openbmc_project/inventory/system/chassis/board0");
+    Interned b("/xyz/openbmc_project/inventory/system/chassis/board"s + "0");
+    Interned c("/xyz/openbmc_project/inventory/system/chassis/board1");
+
+    // Equal strings are kept once.
+    EXPECT_EQ(&a.str(), &b.str());
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(Interned::count(), count + 2);
+
+    // Handles order as their strings.
+    EXPECT_LT(a, c);
+    EXPECT_EQ(c, "/xyz/openbmc_project/inventory/system/chassis/board1");
+    EXPECT_GT(c, "/xyz/openbmc_project/inventory/system/chassis/board0");
+    EXPECT_EQ(Interned(), ""s);
+}
+
+TEST(InternTest, TestLookup)
+{
+    std::map<Interned, int, std::less<>> m;
+    m.emplace(Interned("fans"), 1);
+    m.emplace(Interned("sensors"), 2);
+
+    // Maps keyed by handles can be searched without interning.
+    auto count = Interned::count();
+    auto it = m.find("sensors"s);
+    ASSERT_NE(it, m.end());
+    EXPECT_EQ(it->second, 2);
+    EXPECT_EQ(m.find("leds"), m.end());
+    EXPECT_EQ(Interned::count(), count);
+}
+
+TEST(InternTest, TestRelease)
+{
+    auto count = Interned::count();
+    {
+        Interned a("/xyz/openbmc_project/inventory/system/chassis/fan0");
+        auto b = a;
+        Interned c;
+        c = b;
+        EXPECT_EQ(Interned::count(), count + 1);
+
+        // The string is kept while any handle refers to it.
+        a = Interned();
+        b = std::move(c);
+        EXPECT_EQ(c, ""s);
+        EXPECT_EQ(Interned::count(), count + 1);
+        EXPECT_EQ(b, "/xyz/openbmc_project/inventory/system/chassis/fan0");
+    }
+
+    // And released with the last one.
+    EXPECT_EQ(Interned::count(), count);
+    EXPECT_EQ(Interned(""), Interned());
+    EXPECT_EQ(Interned::count(), count);
+}
+
+TEST(InternTest, TestConcurrentRelease)
+{
+    auto count = Interned::count();
+    {
+        // Copies of a held string are released without dropping it.
+        Interned held("/fan3");
+        auto churn = [&held](int offset) {
+            for (auto i = 0; i < 10000; ++i)
+            {
+                Interned a("/fan" + std::to_string((i + offset) % 16));
+                auto b = a;
+                Interned c(b.str());
+                EXPECT_EQ(&a.str(), &c.str());
+                auto d = held;
+                EXPECT_EQ(&d.str(), &held.str());
+            }
+        };
+        std::thread t1(churn, 0);
+        std::thread t2(churn, 7);
+        t1.join();
+        t2.join();
+        EXPECT_EQ(held, "/fan3"s);
+    }
+    EXPECT_EQ(Interned::count(), count);
+}
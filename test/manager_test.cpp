@@ -1 +1,569 @@
 #include "../manager.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdeventplus/event.hpp>
+#include <xyz/openbmc_project/Common/error.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+using namespace sdbusplus::xyz::openbmc_project::Common::Error;
+using namespace std::literals::chrono_literals;
+using namespace std::literals::string_literals;
+
+namespace
+{
+constexpr auto root = "/xyz/openbmc_project/inventory_test";
+constexpr auto itemIface = "xyz.openbmc_project.Inventory.Item";
+constexpr auto cpuIface = "xyz.openbmc_project.Inventory.Item.Cpu";
+constexpr auto busName = "xyz.openbmc_project.Inventory.ManagerTest";
+
+/** @brief Drives a Manager on its own bus connection.
+ *
+ *  The tests are skipped where there is no bus to connect to, or the
+ *  inventory can't be persisted.
+ */
+class ManagerTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        std::error_code ec;
+        fs::remove_all(persisted(), ec);
+        fs::create_directories(persisted(), ec);
+        if (ec)
+        {
+            GTEST_SKIP() << "Can't persist to " << persisted();
+        }
+
+        try
+        {
+            auto bus = sdbusplus::bus::new_bus();
+            service = bus.get_unique_name();
+            manager = std::make_unique<Manager>(std::move(bus), root);
+        }
+        catch (const sdbusplus::exception_t& e)
+        {
+            GTEST_SKIP() << "No bus: " << e.what();
+        }
+    }
+
+    void TearDown() override
+    {
+        manager.reset();
+        std::error_code ec;
+        fs::remove_all(persisted(), ec);
+    }
+
+    /** @brief Where the test inventory is persisted. */
+    static fs::path persisted()
+    {
+        return fs::path(PIM_PERSIST_PATH) / fs::path(root).relative_path();
+    }
+
+    /** @brief Add or update an item with Notify. */
+    void notify(const std::string& path, const std::string& prettyName)
+    {
+        manager->notify({{path, {{itemIface, {{"PrettyName", prettyName}}}}}});
+        manager->drainQueue();
+    }
+
+    /** @brief Run the manager's event loop until a function, called on
+     *      another thread with a connection of its own, returns.
+     */
+    template <typename F>
+    auto call(F&& f)
+    {
+        auto result = std::async(std::launch::async, [&f]() {
+            auto client = sdbusplus::bus::new_bus();
+            return f(client);
+        });
+        auto event = sdeventplus::Event::get_default();
+        while (result.wait_for(0s) != std::future_status::ready)
+        {
+            event.run(10ms);
+        }
+
+        // Finish the work the call left behind.
+        while (event.run(0us) > 0)
+        {}
+        return result.get();
+    }
+
+    /** @brief Serve the inventory under a bus name, as PIM does, until a
+     *      function, called on another thread with a connection of its
+     *      own, returns.
+     *
+     *  @returns False if the name couldn't be taken.
+     */
+    template <typename F>
+    bool serve(F&& f)
+    {
+        auto result = std::async(std::launch::async, [this, &f]() {
+            struct Stop
+            {
+                ~Stop()
+                {
+                    manager.shutdown();
+                }
+                Manager& manager;
+            } stop{*manager};
+
+            // Changes are announced once the manager owns its name.
+            auto client = sdbusplus::bus::new_bus();
+            auto deadline = std::chrono::steady_clock::now() + 5s;
+            for (auto owned = false; !owned;)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    throw std::runtime_error("The name wasn't taken");
+                }
+                auto m = client.new_method_call(
+                    "org.freedesktop.DBus", "/org/freedesktop/DBus",
+                    "org.freedesktop.DBus", "NameHasOwner");
+                m.append(busName);
+                client.call(m).read(owned);
+            }
+            f(client);
+        });
+
+        try
+        {
+            manager->run(busName);
+        }
+        catch (const sdbusplus::exception_t&)
+        {
+            result.wait();
+            return false;
+        }
+        result.get();
+        return true;
+    }
+
+    /** @brief Add or update an item with Notify over DBus. */
+    void notify(sdbusplus::bus_t& client, const std::string& path,
+                const std::string& prettyName)
+    {
+        using Properties = std::map<std::string, std::variant<std::string>>;
+        std::map<sdbusplus::object_path, std::map<std::string, Properties>>
+            objects{{root + path, {{itemIface, {{"PrettyName", prettyName}}}}}};
+
+        auto m = client.new_method_call(busName, root, IFACE, "Notify");
+        m.append(objects);
+        client.call(m);
+    }
+
+    /** @brief Handle a client's signals until a condition holds or a
+     *      time has passed.
+     */
+    template <typename F>
+    static void pump(sdbusplus::bus_t& client, F&& until,
+                     std::chrono::milliseconds timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!until() && std::chrono::steady_clock::now() < deadline)
+        {
+            while (client.process_discard())
+            {}
+            client.wait(10ms);
+        }
+    }
+
+    /** @brief Set a property over DBus. */
+    void set(const std::string& path, const char* property,
+             const std::string& value)
+    {
+        call([&](sdbusplus::bus_t& client) {
+            auto m = client.new_method_call(
+                service.c_str(), (root + path).c_str(),
+                "org.freedesktop.DBus.Properties", "Set");
+            m.append(itemIface, property, std::variant<std::string>(value));
+            client.call(m);
+        });
+    }
+
+    /** @brief Read a property of an item from the inventory. */
+    std::optional<InterfaceVariantType>
+        property(const std::string& path, const char* property)
+    {
+        auto [objects, cursor] = manager->getObjects(path, {itemIface}, "", 1);
+        auto object = objects.find(path);
+        if (object == objects.end())
+        {
+            return std::nullopt;
+        }
+        auto iface = object->second.find(itemIface);
+        if (iface == object->second.end())
+        {
+            return std::nullopt;
+        }
+        auto it = iface->second.find(property);
+        if (it == iface->second.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /** @brief Read a property from the current snapshot. */
+    std::optional<InterfaceVariantType>
+        snapshotted(const std::string& path, const char* property)
+    {
+        const auto* object = manager->snapshot()->find(path);
+        if (!object)
+        {
+            return std::nullopt;
+        }
+        auto iface = object->find(itemIface);
+        if (iface == object->end())
+        {
+            return std::nullopt;
+        }
+        auto it = iface->second->find(property);
+        if (it == iface->second->end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    /** @brief Whether an object, or one of its interfaces, is persisted. */
+    static bool isPersisted(const std::string& path,
+                            const char* interface = "")
+    {
+        if (SerialOps::workers)
+        {
+            SerialOps::workers->flush();
+        }
+        return fs::exists(persisted() / fs::path(path).relative_path() /
+                          interface);
+    }
+
+    /** @brief Read the file an interface of an object is persisted in. */
+    static std::string persistedFile(const std::string& path,
+                                     const char* interface)
+    {
+        if (SerialOps::workers)
+        {
+            SerialOps::workers->flush();
+        }
+        std::ifstream is(persisted() / fs::path(path).relative_path() /
+                         interface);
+        return {std::istreambuf_iterator<char>(is), {}};
+    }
+
+    std::string service;
+    std::unique_ptr<Manager> manager;
+};
+} // namespace
+
+#ifdef SNAPSHOTS
+TEST_F(ManagerTest, TestSetReachesSnapshot)
+{
+    notify("/cpu0", "cpu");
+    EXPECT_EQ(snapshotted("/cpu0", "PrettyName"),
+              InterfaceVariantType("cpu"s));
+
+    // A client's write is published as though it came with Notify.
+    set("/cpu0", "PrettyName", "cpu0");
+    EXPECT_EQ(snapshotted("/cpu0", "PrettyName"),
+              InterfaceVariantType("cpu0"s));
+    EXPECT_NE(persistedFile("/cpu0", itemIface).find("\"cpu0\""),
+              std::string::npos);
+}
+#endif
+
+TEST_F(ManagerTest, TestQueuedFailureIsPerObject)
+{
+    if (!NOTIFY_QUEUE_LIMIT)
+    {
+        GTEST_SKIP() << "Notify isn't queued";
+    }
+
+    // Present is a bool.  The queue only checks that it has room.
+    EXPECT_NO_THROW(manager->notify(
+        {{"/bad"s, {{itemIface, {{"Present", "yes"s}}}}},
+         {"/good"s, {{itemIface, {{"PrettyName", "good"s}}}}}}));
+
+    // The bad object doesn't keep the good one from being applied.
+    EXPECT_NO_THROW(manager->drainQueue());
+    EXPECT_EQ(property("/good", "PrettyName"), InterfaceVariantType("good"s));
+#ifndef COMPACT_STORE
+    EXPECT_EQ(manager->statistics()["NotifyFailed"], 1u);
+#endif
+}
+
+TEST_F(ManagerTest, TestGetObjectsPages)
+{
+    NotifyObjects objects;
+    for (auto i = 0; i < 5; ++i)
+    {
+        objects.emplace(
+            "/page/cpu" + std::to_string(i),
+            NotifyObjects::mapped_type{{itemIface, {{"PrettyName", "cpu"s}}}});
+    }
+    manager->notify(std::move(objects));
+    manager->drainQueue();
+
+    // The pages resume where the last ended, and end with the subtree.
+    std::vector<std::string> paths;
+    std::string cursor;
+    do
+    {
+        auto [page, next] = manager->getObjects("/page", {}, cursor, 2);
+        EXPECT_LE(page.size(), 2u);
+        for (const auto& [path, object] : page)
+        {
+            paths.push_back(path.str);
+        }
+        cursor = std::move(next);
+    } while (!cursor.empty());
+    EXPECT_EQ(paths, (std::vector<std::string>{"/page/cpu0", "/page/cpu1",
+                                               "/page/cpu2", "/page/cpu3",
+                                               "/page/cpu4"}));
+
+    EXPECT_THROW(manager->getObjects("/page", {}, "", 0), InvalidArgument);
+}
+
+TEST_F(ManagerTest, TestGetObjectsScanLimit)
+{
+    // Only the last of more than 1024 objects has the interface asked
+    // for.
+    NotifyObjects objects;
+    for (auto i = 0; i < 1100; ++i)
+    {
+        objects.emplace(
+            "/scan/item" + std::to_string(1000 + i),
+            NotifyObjects::mapped_type{{itemIface, {{"PrettyName", "cpu"s}}}});
+    }
+    objects.emplace("/scan/socket", NotifyObjects::mapped_type{{cpuIface, {}}});
+    manager->notify(std::move(objects));
+    manager->drainQueue();
+
+    // The first page stops short, and the next finds the object.
+    auto [first, cursor] = manager->getObjects("/scan", {cpuIface}, "", 1);
+    EXPECT_TRUE(first.empty());
+    ASSERT_FALSE(cursor.empty());
+
+    auto [second, next] = manager->getObjects("/scan", {cpuIface}, cursor, 1);
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(second.begin()->first.str, "/scan/socket");
+    EXPECT_TRUE(next.empty());
+}
+
+TEST_F(ManagerTest, TestQuery)
+{
+    try
+    {
+        manager->query(itemIface, {}, "", 1);
+    }
+    catch (const InvalidArgument&)
+    {
+        GTEST_SKIP() << itemIface << " isn't indexed";
+    }
+
+    notify("/cpu0", "cpu0");
+    notify("/cpu1", "cpu1");
+    notify("/cpu2", "cpu2");
+
+    std::vector<std::string> paths;
+    std::string cursor;
+    do
+    {
+        auto [page, next] = manager->query(itemIface, {}, cursor, 2);
+        for (const auto& path : page)
+        {
+            paths.push_back(path.str);
+        }
+        cursor = std::move(next);
+    } while (!cursor.empty());
+    EXPECT_EQ(paths, (std::vector<std::string>{"/cpu0", "/cpu1", "/cpu2"}));
+
+    EXPECT_THROW(manager->query(itemIface, {}, "", 0), InvalidArgument);
+    EXPECT_THROW(manager->query(cpuIface, {{"Unknown", "x"s}}, "", 1),
+                 InvalidArgument);
+}
+
+TEST_F(ManagerTest, TestApplyDelta)
+{
+    manager->notify(
+        {{"/cpu0"s,
+          {{itemIface, {{"PrettyName", "cpu"s}, {"Present", true}}},
+           {cpuIface, {}}}}});
+    manager->drainQueue();
+    ASSERT_TRUE(isPersisted("/cpu0", cpuIface));
+
+    // An interface both removed and updated is recreated with only the
+    // new properties.
+    std::map<sdbusplus::object_path, Object> update{
+        {"/cpu0"s, {{itemIface, {{"PrettyName", "cpu0"s}}}}},
+        {"/cpu1"s, {{itemIface, {{"PrettyName", "cpu1"s}}}}}};
+    manager->applyDelta(std::move(update),
+                        {{"/cpu0"s, {itemIface, cpuIface}}});
+
+    EXPECT_EQ(property("/cpu0", "PrettyName"), InterfaceVariantType("cpu0"s));
+    EXPECT_EQ(property("/cpu0", "Present"), InterfaceVariantType(false));
+    EXPECT_EQ(property("/cpu1", "PrettyName"), InterfaceVariantType("cpu1"s));
+    EXPECT_FALSE(isPersisted("/cpu0", cpuIface));
+
+    auto [objects, cursor] = manager->getObjects("/cpu0", {cpuIface}, "", 1);
+    EXPECT_TRUE(objects.empty());
+}
+
+TEST_F(ManagerTest, TestTransactionOwner)
+{
+    manager->beginTransaction("a");
+
+    // Persisting is held until the owner commits.
+    notify("/cpu0", "cpu0");
+    EXPECT_FALSE(isPersisted("/cpu0", itemIface));
+
+    EXPECT_THROW(manager->beginTransaction("b"), Unavailable);
+    EXPECT_THROW(manager->commitTransaction("b"), NotAllowed);
+
+    // Transactions nest.
+    manager->beginTransaction("a");
+    manager->commitTransaction("a");
+    EXPECT_FALSE(isPersisted("/cpu0", itemIface));
+    manager->commitTransaction("a");
+    EXPECT_TRUE(isPersisted("/cpu0", itemIface));
+
+    EXPECT_THROW(manager->commitTransaction("a"), std::runtime_error);
+
+    // Another client may begin once it is committed.
+    manager->beginTransaction("b");
+    manager->commitTransaction("b");
+}
+
+TEST_F(ManagerTest, TestTransactionClientGone)
+{
+    manager->beginTransaction("a");
+    notify("/cpu0", "cpu0");
+
+    // Only the owner going away commits the transaction.
+    manager->clientGone("b");
+    EXPECT_FALSE(isPersisted("/cpu0", itemIface));
+    manager->clientGone("a");
+    EXPECT_TRUE(isPersisted("/cpu0", itemIface));
+
+    EXPECT_THROW(manager->commitTransaction("a"), std::runtime_error);
+    manager->beginTransaction("b");
+    manager->commitTransaction("b");
+}
+
+TEST_F(ManagerTest, TestChangesSince)
+{
+    notify("/cpu0", "cpu0");
+    auto base = manager->changesSince(0, 0);
+    EXPECT_EQ(base.generation, manager->snapshot()->version);
+
+    notify("/cpu1", "cpu1");
+    manager->applyDelta({}, {{"/cpu0"s, {itemIface}}});
+
+    auto changes = manager->changesSince(base.stream, base.generation);
+#ifdef SNAPSHOTS
+    ASSERT_FALSE(changes.resync);
+    EXPECT_EQ(changes.generation, manager->snapshot()->version);
+
+    ASSERT_EQ(changes.update.size(), 1u);
+    auto cpu1 = changes.update.find(sdbusplus::object_path("/cpu1"));
+    ASSERT_NE(cpu1, changes.update.end());
+    auto item = cpu1->second.find(itemIface);
+    ASSERT_NE(item, cpu1->second.end());
+    EXPECT_EQ(item->second.find("PrettyName")->second,
+              InterfaceVariantType("cpu1"s));
+
+    EXPECT_EQ(changes.remove,
+              (std::map<sdbusplus::object_path, std::vector<std::string>>{
+                  {"/cpu0"s, {itemIface}}}));
+
+    // Generations from another stream can't be brought up to date.
+    EXPECT_TRUE(
+        manager->changesSince(base.stream + 1, base.generation).resync);
+#else
+    // Without snapshots there is no change log.
+    EXPECT_TRUE(changes.resync);
+#endif
+}
+
+TEST_F(ManagerTest, TestDestroySubtree)
+{
+    notify("/system", "system");
+    notify("/system/cpu0", "cpu0");
+    notify("/system/cpu0/core0", "core0");
+    notify("/system_x", "system_x");
+
+    manager->destroySubtree("/system");
+
+    EXPECT_FALSE(property("/system", "PrettyName"));
+    EXPECT_FALSE(property("/system/cpu0", "PrettyName"));
+    EXPECT_FALSE(property("/system/cpu0/core0", "PrettyName"));
+    EXPECT_FALSE(isPersisted("/system"));
+
+    // Objects that only share the name as a prefix are kept.
+    EXPECT_EQ(property("/system_x", "PrettyName"),
+              InterfaceVariantType("system_x"s));
+    EXPECT_TRUE(isPersisted("/system_x"));
+}
+
+TEST_F(ManagerTest, TestSignalsCoalesced)
+{
+    auto added = 0;
+    auto changed = 0;
+    auto inWindow = true;
+    auto served = serve([&](sdbusplus::bus_t& client) {
+        namespace rules = sdbusplus::bus::match::rules;
+        auto path = root + "/cpu0"s;
+        sdbusplus::bus::match_t addedMatch(
+            client, rules::interfacesAdded(),
+            [&](sdbusplus::message_t& m) {
+                sdbusplus::object_path p;
+                m.read(p);
+                added += p.str == path;
+            });
+        sdbusplus::bus::match_t changedMatch(
+            client, rules::propertiesChanged(path, itemIface),
+            [&](sdbusplus::message_t&) { ++changed; });
+
+        notify(client, "/cpu0", "a");
+        pump(client, [&]() { return added > 0; }, 1s);
+
+        // Two updates inside the coalescing window are announced once.
+        auto start = std::chrono::steady_clock::now();
+        notify(client, "/cpu0", "b");
+        notify(client, "/cpu0", "c");
+        inWindow = std::chrono::steady_clock::now() - start <
+                   std::chrono::milliseconds(SIGNAL_COALESCE_MS);
+        pump(client, [&]() { return changed > 1; },
+             std::chrono::milliseconds(SIGNAL_COALESCE_MS) + 500ms);
+    });
+    if (!served)
+    {
+        GTEST_SKIP() << "Can't own " << busName;
+    }
+
+    EXPECT_EQ(added, 1);
+    if (!SIGNAL_COALESCE_MS)
+    {
+        EXPECT_EQ(changed, 2);
+    }
+    else if (inWindow)
+    {
+        EXPECT_EQ(changed, 1);
+    }
+}
@@ -0,0 +1,129 @@
+#include "config.h"
+
+#include "../types.hpp"
+
+#include <sdbusplus/bus.hpp>
+#include <systemd/sd-bus.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace phosphor::inventory::manager;
+
+namespace
+{
+constexpr auto objects = 2000;
+constexpr auto itemIface = "xyz.openbmc_project.Inventory.Item";
+
+/** @brief Connect to a peer-to-peer socket. */
+std::optional<sdbusplus::bus_t> connectPeer(const char* path)
+{
+    sd_bus* b = nullptr;
+    if (sd_bus_new(&b) < 0)
+    {
+        return std::nullopt;
+    }
+    sdbusplus::bus_t bus{b, std::false_type{}};
+    auto address = std::string("unix:path=") + path;
+    if (sd_bus_set_address(b, address.c_str()) < 0 || sd_bus_start(b) < 0)
+    {
+        return std::nullopt;
+    }
+    return bus;
+}
+
+/** @brief Send one Notify per object and time them.
+ *
+ *  @param[in] bus - The connection to send on.
+ *  @param[in] service - The destination, or nullptr for a peer.
+ *  @param[in] round - Makes the values differ from the last round's.
+ *
+ *  @returns Notify calls per second.
+ */
+double notifyRate(sdbusplus::bus_t& bus, const char* service, int round)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < objects; ++i)
+    {
+        NotifyObjects objs{
+            {sdbusplus::object_path("/benchmark/item" + std::to_string(i)),
+             {{itemIface,
+               {{"PrettyName", "round " + std::to_string(round)},
+                {"Present", true}}}}}};
+        auto m = bus.new_method_call(service, INVENTORY_ROOT, IFACE, "Notify");
+        m.append(objs);
+        bus.call(m);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return objects / elapsed.count();
+}
+
+/** @brief Remove the benchmark objects. */
+void cleanup(sdbusplus::bus_t& bus, const char* service)
+{
+    std::map<sdbusplus::object_path, Object> update;
+    std::map<sdbusplus::object_path, std::vector<std::string>> remove;
+    for (auto i = 0; i < objects; ++i)
+    {
+        remove.emplace("/benchmark/item" + std::to_string(i),
+                       std::vector<std::string>{itemIface});
+    }
+    auto m = bus.new_method_call(service, INVENTORY_ROOT, EXTENSIONS_IFACE,
+                                 "ApplyDelta");
+    m.append(update, remove);
+    bus.call(m);
+}
+} // namespace
+
+int main()
+{
+    std::optional<sdbusplus::bus_t> system;
+    try
+    {
+        system = sdbusplus::bus::new_system();
+        // Create the objects first, so each run measures updates.
+        notifyRate(*system, BUSNAME, 0);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "skipped: inventory manager not reachable on the "
+                     "system bus: "
+                  << e.what() << "\n";
+        return 0;
+    }
+
+    std::cout << objects << " sequential Notify calls\n";
+    std::cout << "system bus: " << notifyRate(*system, BUSNAME, 1)
+              << " calls/s\n";
+
+    std::optional<sdbusplus::bus_t> peer;
+    if (std::strlen(PEER_SOCKET))
+    {
+        peer = connectPeer(PEER_SOCKET);
+    }
+    if (peer)
+    {
+        try
+        {
+            std::cout << "peer socket: " << notifyRate(*peer, nullptr, 2)
+                      << " calls/s\n";
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "peer socket failed: " << e.what() << "\n";
+        }
+    }
+    else
+    {
+        std::cout << "peer socket: skipped, not configured or not reachable\n";
+    }
+
+    cleanup(*system, BUSNAME);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "../serialize.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+std::size_t allocations = 0;
+
+constexpr auto objects = 256;
+constexpr auto interfaces = 8;
+constexpr auto rounds = 64;
+const auto root = "/xyz/openbmc_project/inventory"s;
+
+/** @brief Report the mean heap allocations and latency of a scan. */
+void report(const char* name, const fs::path& store, bool useArena)
+{
+    std::size_t total = 0;
+    std::chrono::nanoseconds elapsed{};
+    for (auto i = 0; i < rounds; ++i)
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        auto before = allocations;
+        auto start = std::chrono::steady_clock::now();
+        {
+            auto scanned = detail::scanStorage(
+                store, root,
+                useArena ? &arena : std::pmr::new_delete_resource());
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        total += allocations - before;
+    }
+
+    std::cout << name << ": " << total / rounds << " allocations, "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     elapsed / rounds)
+                     .count()
+              << " us per scan\n";
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Memory resources allocate with the aligned overloads.
+void* operator new(std::size_t size, std::align_val_t align)
+{
+    ++allocations;
+    auto alignment = static_cast<std::size_t>(align);
+    if (auto p = std::aligned_alloc(
+            alignment, (size + alignment - 1) / alignment * alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+int main()
+{
+    char dir[] = {"scanBenchXXXXXX"};
+    fs::path store = mkdtemp(dir);
+
+    for (auto o = 0; o < objects; ++o)
+    {
+        auto path = store / fs::path(root).relative_path() / "system" /
+                    "chassis" / ("board" + std::to_string(o));
+        fs::create_directories(path);
+        for (auto i = 0; i < interfaces; ++i)
+        {
+            std::ofstream{path / ("xyz.openbmc_project.Inventory.Decorator" +
+                                  std::to_string(i))};
+        }
+    }
+
+    std::cout << objects << " objects, " << interfaces
+              << " interfaces each\n";
+    report("heap", store, false);
+    report("arena", store, true);
+
+    fs::remove_all(store);
+    return 0;
+}
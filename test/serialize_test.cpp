@@ -1,9 +1,14 @@
 #include "../serialize.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
 #include <gtest/gtest.h>
 
 using namespace phosphor::inventory::manager;
 using namespace std::string_literals;
+using namespace std::string_view_literals;
 
 TEST(SerializeTest, TestStoragePathNoSlashes)
 {
@@ -22,3 +27,117 @@ TEST(SerializeTest, TestStoragePathSlashes)
     auto p2 = fs::path(PIM_PERSIST_PATH "/foo/bar/baz/xyz.foo");
     EXPECT_EQ(p1, p2);
 }
+
+TEST(SerializeTest, TestScanStorage)
+{
+    char dir[] = {"scanTestXXXXXX"};
+    fs::path store = mkdtemp(dir);
+    auto root = "/xyz/openbmc_project/inventory"s;
+
+    auto touch = [&](const std::string& path, const std::string& iface) {
+        auto p = store / fs::path(root + path).relative_path();
+        fs::create_directories(p);
+        std::ofstream{p / iface};
+    };
+    touch("/system", "xyz.foo");
+    touch("/system/chassis", "xyz.foo");
+    touch("/system/chassis", "xyz.bar");
+
+    std::pmr::monotonic_buffer_resource arena;
+    auto objects = detail::scanStorage(store, root, &arena);
+    fs::remove_all(store);
+
+    ASSERT_EQ(objects.size(), 2);
+
+    auto system = objects.find("/system"sv);
+    ASSERT_NE(system, objects.end());
+    EXPECT_EQ(system->second.size(), 1);
+    EXPECT_EQ(system->second[0], "xyz.foo"sv);
+
+    auto chassis = objects.find("/system/chassis"sv);
+    ASSERT_NE(chassis, objects.end());
+    std::vector<std::string_view> ifaces{chassis->second.begin(),
+                                         chassis->second.end()};
+    std::sort(ifaces.begin(), ifaces.end());
+    EXPECT_EQ(ifaces, (std::vector<std::string_view>{"xyz.bar", "xyz.foo"}));
+}
+
+TEST(SerializeTest, TestScanStorageMissing)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    auto objects =
+        detail::scanStorage("scanTestMissing", "/xyz/openbmc_project", &arena);
+    EXPECT_TRUE(objects.empty());
+}
+
+TEST(SerializeTest, TestPersistWorkers)
+{
+    char dir[] = {"persistTestXXXXXX"};
+    fs::path store = mkdtemp(dir);
+    auto read = [](const fs::path& p) {
+        std::ifstream is(p);
+        return std::string(std::istreambuf_iterator<char>(is), {});
+    };
+
+    {
+        PersistWorkers workers({"/system/chassis0", "/system/chassis1"});
+
+        // Work on one path is done in order.
+        for (auto i = 0; i < 100; ++i)
+        {
+            workers.write("/system/chassis0/cpu", store / "0/cpu/xyz.foo",
+                          std::to_string(i));
+            workers.write("/system/chassis1/cpu", store / "1/cpu/xyz.foo",
+                          std::to_string(i));
+            workers.write("/system/chassis10", store / "10/xyz.foo",
+                          std::to_string(i));
+        }
+        workers.write("/system", store / "xyz.bar", "bar");
+        workers.remove("/system", store / "xyz.bar");
+        workers.flush();
+
+        EXPECT_EQ(read(store / "0/cpu/xyz.foo"), "99");
+        EXPECT_EQ(read(store / "1/cpu/xyz.foo"), "99");
+        EXPECT_EQ(read(store / "10/xyz.foo"), "99");
+        EXPECT_FALSE(fs::exists(store / "xyz.bar"));
+
+        // Queued work is done before the workers stop.
+        workers.write("/system", store / "xyz.baz", "baz");
+    }
+
+    EXPECT_EQ(read(store / "xyz.baz"), "baz");
+    fs::remove_all(store);
+}
+
+TEST(SerializeTest, TestPersistWorkersRemoveAll)
+{
+    char dir[] = {"persistTestXXXXXX"};
+    fs::path store = mkdtemp(dir);
+
+    {
+        PersistWorkers workers({"/system/chassis0", "/other"});
+
+        // The subtree spans shards.  Writes queued before the removal
+        // are removed, and those queued after it are kept.
+        for (auto i = 0; i < 100; ++i)
+        {
+            workers.write("/system/chassis0/cpu",
+                          store / "system/chassis0/cpu/xyz.foo",
+                          std::to_string(i));
+            workers.write("/system", store / "system/xyz.foo",
+                          std::to_string(i));
+        }
+        workers.write("/other", store / "other/xyz.foo", "other");
+        workers.removeAll("/system", store / "system");
+        workers.write("/system/chassis0", store / "system/chassis0/xyz.bar",
+                      "bar");
+        workers.flush();
+
+        EXPECT_FALSE(fs::exists(store / "system/chassis0/cpu"));
+        EXPECT_FALSE(fs::exists(store / "system/xyz.foo"));
+        EXPECT_TRUE(fs::exists(store / "system/chassis0/xyz.bar"));
+        EXPECT_TRUE(fs::exists(store / "other/xyz.foo"));
+    }
+
+    fs::remove_all(store);
+}
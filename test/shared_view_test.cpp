@@ -0,0 +1,201 @@
+#include "../shared_view.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::view;
+using namespace std::string_literals;
+
+namespace
+{
+std::string tempPath()
+{
+    char dir[] = {"viewTestXXXXXX"};
+    return std::filesystem::absolute(mkdtemp(dir)) / "view";
+}
+
+/** @brief Stage an object with the value v. */
+void update(Writer& writer, int i, int64_t v)
+{
+    auto path = "/inventory/item" + std::to_string(i);
+    Encoder e;
+    e.object(path, 2);
+    e.interface("xyz.foo", 2);
+    e.property("Value", v);
+    e.property("Name", "item"s + std::to_string(i));
+    e.interface("xyz.bar", 3);
+    e.property("Present", true);
+    e.property("Data", std::vector<uint8_t>{1, 2, 3});
+    e.property("Names", std::vector<std::string>{"a", "b"});
+    writer.update(path, e.image());
+}
+
+/** @brief Publish count objects, each with the value v. */
+void publish(Writer& writer, int count, int64_t v, std::uint64_t version)
+{
+    for (auto i = 0; i < count; ++i)
+    {
+        update(writer, i, v);
+    }
+    writer.publish(version);
+}
+} // namespace
+
+TEST(SharedViewTest, TestRoundTrip)
+{
+    auto path = tempPath();
+    Writer writer(path);
+    Reader reader(path);
+
+    auto empty = reader.read();
+    ASSERT_TRUE(empty);
+    EXPECT_TRUE(empty->empty());
+
+    publish(writer, 2, 42, 7);
+    auto objects = reader.read();
+    ASSERT_TRUE(objects);
+    EXPECT_EQ(reader.version(), 7);
+    ASSERT_EQ(objects->size(), 2);
+
+    const auto& item = objects->at("/inventory/item1");
+    EXPECT_EQ(std::get<int64_t>(item.at("xyz.foo").at("Value")), 42);
+    EXPECT_EQ(std::get<std::string>(item.at("xyz.foo").at("Name")), "item1");
+    EXPECT_EQ(std::get<bool>(item.at("xyz.bar").at("Present")), true);
+    EXPECT_EQ(std::get<std::vector<uint8_t>>(item.at("xyz.bar").at("Data")),
+              (std::vector<uint8_t>{1, 2, 3}));
+    EXPECT_EQ(
+        std::get<std::vector<std::string>>(item.at("xyz.bar").at("Names")),
+        (std::vector<std::string>{"a", "b"}));
+
+    // Nothing is decoded when the version has not moved.
+    EXPECT_FALSE(reader.read(7));
+
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
+
+TEST(SharedViewTest, TestUpdate)
+{
+    auto path = tempPath();
+    Writer writer(path);
+    Reader reader(path);
+    publish(writer, 4, 1, 1);
+
+    // Only the staged objects change.
+    update(writer, 2, 2);
+    writer.remove("/inventory/item3");
+    writer.remove("/inventory/item9");
+    writer.publish(2);
+    auto objects = reader.read(1);
+    ASSERT_TRUE(objects);
+    ASSERT_EQ(objects->size(), 3);
+    EXPECT_EQ(std::get<int64_t>(
+                  objects->at("/inventory/item0").at("xyz.foo").at("Value")),
+              1);
+    EXPECT_EQ(std::get<int64_t>(
+                  objects->at("/inventory/item2").at("xyz.foo").at("Value")),
+              2);
+    EXPECT_FALSE(objects->contains("/inventory/item3"));
+
+    // Replaced records are compacted away as they pile up.
+    for (auto v = 3; v < 1000; ++v)
+    {
+        update(writer, v % 3, v);
+        writer.publish(v);
+    }
+    objects = reader.read();
+    ASSERT_EQ(objects->size(), 3);
+    EXPECT_EQ(std::get<int64_t>(
+                  objects->at("/inventory/item0").at("xyz.foo").at("Value")),
+              999);
+    EXPECT_EQ(std::get<int64_t>(
+                  objects->at("/inventory/item1").at("xyz.foo").at("Value")),
+              997);
+    EXPECT_LT(std::filesystem::file_size(path), 2 * 64 * 1024);
+
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
+
+TEST(SharedViewTest, TestGrowth)
+{
+    auto path = tempPath();
+    Writer writer(path);
+    Reader reader(path);
+
+    // Well past the initial capacity.
+    publish(writer, 5000, 1, 1);
+    auto objects = reader.read();
+    ASSERT_TRUE(objects);
+    EXPECT_EQ(objects->size(), 5000);
+
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
+
+TEST(SharedViewTest, TestRestart)
+{
+    auto path = tempPath();
+    auto writer = std::make_unique<Writer>(path);
+    publish(*writer, 1, 1, 1);
+    Reader reader(path);
+    EXPECT_EQ(reader.read()->size(), 1);
+    auto stream = reader.stream();
+
+    // A new writer replaces the image, and the reader follows it, even
+    // though the new image has the same version.
+    auto replacement = std::make_unique<Writer>(path);
+    publish(*replacement, 3, 2, 1);
+    writer.reset();
+    auto objects = reader.read(1);
+    ASSERT_TRUE(objects);
+    EXPECT_EQ(objects->size(), 3);
+    EXPECT_NE(reader.stream(), stream);
+    EXPECT_FALSE(reader.read(1));
+
+    // Without a writer there is nothing to read.
+    replacement.reset();
+    EXPECT_THROW(reader.read(), std::system_error);
+    EXPECT_THROW(Reader{path}, std::system_error);
+
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
+
+TEST(SharedViewTest, TestConcurrentReader)
+{
+    auto path = tempPath();
+    Writer writer(path);
+    std::atomic<bool> done = false;
+    std::atomic<bool> consistent = true;
+
+    // Every value in an image is its version, and images grow with the
+    // version, so torn reads would show.
+    std::thread thread([&]() {
+        Reader reader(path);
+        while (!done)
+        {
+            auto objects = reader.read();
+            for (const auto& [object, interfaces] : *objects)
+            {
+                const auto& value = interfaces.at("xyz.foo").at("Value");
+                if (std::get<int64_t>(value) !=
+                    static_cast<int64_t>(reader.version()))
+                {
+                    consistent = false;
+                }
+            }
+        }
+    });
+
+    for (auto v = 1; v <= 500; ++v)
+    {
+        publish(writer, v, v, v);
+    }
+    done = true;
+    thread.join();
+
+    EXPECT_TRUE(consistent);
+    std::filesystem::remove_all(std::filesystem::path(path).parent_path());
+}
@@ -0,0 +1,205 @@
+#include "../snapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace phosphor::inventory::manager;
+using namespace std::string_literals;
+
+namespace
+{
+SnapshotObject makeObject(int64_t value)
+{
+    return SnapshotObject{
+        {"xyz.foo", std::make_shared<const Interface>(
+                        Interface{{"Value", value}})}};
+}
+
+int64_t valueOf(const SnapshotObject& object)
+{
+    const auto& interface = *object.find("xyz.foo")->second;
+    return std::get<int64_t>(interface.find("Value")->second);
+}
+} // namespace
+
+TEST(SnapshotTest, TestPublish)
+{
+    SnapshotPublisher publisher;
+    auto empty = publisher.current();
+    EXPECT_EQ(empty->version, 0);
+    EXPECT_TRUE(empty->objects.empty());
+
+    publisher.stage("/a", makeObject(1));
+    publisher.stage("/b", makeObject(2));
+
+    // Staged changes are not visible until published.
+    EXPECT_EQ(publisher.current(), empty);
+
+    publisher.publish();
+    auto first = publisher.current();
+    EXPECT_EQ(first->version, 1);
+    ASSERT_NE(first->find("/a"), nullptr);
+    EXPECT_EQ(valueOf(*first->find("/a")), 1);
+    EXPECT_EQ(first->find("/c"), nullptr);
+
+    // Publishing nothing new makes no version.
+    publisher.publish();
+    EXPECT_EQ(publisher.current(), first);
+
+    publisher.stage("/a", makeObject(3));
+    publisher.remove("/b");
+    publisher.publish();
+    auto second = publisher.current();
+    EXPECT_EQ(second->version, 2);
+    EXPECT_EQ(valueOf(*second->find("/a")), 3);
+    EXPECT_EQ(second->find("/b"), nullptr);
+
+    // The older version is unchanged.
+    EXPECT_EQ(valueOf(*first->find("/a")), 1);
+    EXPECT_EQ(valueOf(*first->find("/b")), 2);
+}
+
+TEST(SnapshotTest, TestSharing)
+{
+    SnapshotPublisher publisher;
+    publisher.stage("/a", makeObject(1));
+    publisher.stage("/b", makeObject(2));
+    publisher.publish();
+    auto first = publisher.current();
+
+    publisher.stage("/a", makeObject(3));
+    publisher.publish();
+    auto second = publisher.current();
+
+    EXPECT_EQ(first->find("/b"), second->find("/b"));
+    EXPECT_NE(first->find("/a"), second->find("/a"));
+}
+
+TEST(SnapshotTest, TestChunks)
+{
+    constexpr auto objects = 1000;
+    SnapshotPublisher publisher;
+    for (auto o = 0; o < objects; ++o)
+    {
+        publisher.stage("/" + std::to_string(o), makeObject(o));
+    }
+    publisher.publish();
+    auto first = publisher.current();
+    EXPECT_EQ(first->objects.size(), objects);
+
+    // Objects are iterated in path order across chunks.
+    std::vector<std::string> paths;
+    for (const auto& [path, object] : first->objects)
+    {
+        EXPECT_EQ(valueOf(*object), std::stoi(path.substr(1)));
+        paths.push_back(path);
+    }
+    EXPECT_EQ(paths.size(), objects);
+    EXPECT_TRUE(std::ranges::is_sorted(paths));
+
+    for (auto o = 0; o < objects; o += 2)
+    {
+        publisher.remove("/" + std::to_string(o));
+    }
+    publisher.stage("/5", makeObject(-5));
+    publisher.publish();
+    auto second = publisher.current();
+    EXPECT_EQ(second->objects.size(), objects / 2);
+    EXPECT_EQ(second->find("/4"), nullptr);
+    EXPECT_EQ(valueOf(*second->find("/5")), -5);
+    EXPECT_EQ(second->find("/7"), first->find("/7"));
+
+    // The first version still has every object.
+    EXPECT_EQ(first->objects.size(), objects);
+    for (auto o = 0; o < objects; ++o)
+    {
+        ASSERT_NE(first->find("/" + std::to_string(o)), nullptr);
+        EXPECT_EQ(valueOf(*first->find("/" + std::to_string(o))), o);
+    }
+
+    for (auto o = 1; o < objects; o += 2)
+    {
+        publisher.remove("/" + std::to_string(o));
+    }
+    publisher.publish();
+    EXPECT_TRUE(publisher.current()->objects.empty());
+    EXPECT_EQ(publisher.current()->objects.begin(),
+              publisher.current()->objects.end());
+}
+
+TEST(SnapshotTest, TestReclamation)
+{
+    SnapshotPublisher publisher;
+    publisher.stage("/a", makeObject(1));
+    publisher.publish();
+
+    std::weak_ptr<const Snapshot> first = publisher.current();
+    std::weak_ptr<const SnapshotObject> firstObject =
+        publisher.current()->objects.begin()->second;
+    auto held = publisher.current();
+
+    publisher.stage("/a", makeObject(2));
+    publisher.publish();
+
+    // A reader still holds the first version.
+    EXPECT_FALSE(first.expired());
+    EXPECT_FALSE(firstObject.expired());
+
+    held.reset();
+    EXPECT_TRUE(first.expired());
+    EXPECT_TRUE(firstObject.expired());
+}
+
+TEST(SnapshotTest, TestConcurrentReaders)
+{
+    constexpr auto versions = 2000;
+    constexpr auto objects = 8;
+    SnapshotPublisher publisher;
+    std::atomic<bool> done = false;
+    std::atomic<bool> consistent = true;
+
+    // Every object in a version holds the version number, so a reader
+    // seeing a mix of versions would notice.
+    auto read = [&]() {
+        std::uint64_t last = 0;
+        while (!done)
+        {
+            auto snapshot = publisher.current();
+            if (snapshot->version < last)
+            {
+                consistent = false;
+            }
+            last = snapshot->version;
+            for (const auto& [path, object] : snapshot->objects)
+            {
+                if (valueOf(*object) !=
+                    static_cast<int64_t>(snapshot->version))
+                {
+                    consistent = false;
+                }
+            }
+        }
+    };
+    std::thread r1(read);
+    std::thread r2(read);
+
+    for (auto v = 1; v <= versions; ++v)
+    {
+        for (auto o = 0; o < objects; ++o)
+        {
+            publisher.stage("/" + std::to_string(o), makeObject(v));
+        }
+        publisher.publish();
+    }
+    done = true;
+    r1.join();
+    r2.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(publisher.current()->version, versions);
+}
@@ -0,0 +1,112 @@
+#include "../types.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
+using namespace phosphor::inventory::manager;
+
+namespace
+{
+constexpr auto interfaces = 12;
+constexpr auto properties = 8;
+constexpr auto rounds = 100000;
+
+template <typename T>
+using MapObject = std::map<std::string, std::map<std::string, T>>;
+
+/** @brief Build an object shaped like a typical Notify payload. */
+template <typename O>
+O makeObject()
+{
+    O object;
+    for (auto i = 0; i < interfaces; ++i)
+    {
+        typename O::mapped_type interface;
+        for (auto p = 0; p < properties; ++p)
+        {
+            interface.emplace("Property" + std::to_string(p),
+                              InterfaceVariantType{std::string(32, 'x')});
+        }
+        object.emplace("xyz.openbmc_project.Inventory.Decorator" +
+                           std::to_string(i),
+                       std::move(interface));
+    }
+    return object;
+}
+
+/** @brief Time a function over many rounds, in ns per round. */
+template <typename F>
+auto measure(F&& f)
+{
+    // Keep the results live so the work is not optimized away.
+    static volatile std::size_t sink;
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < rounds; ++i)
+    {
+        sink = sink + f();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+               .count() /
+           rounds;
+}
+
+template <typename O>
+void report(const char* name, const O& object,
+            const std::vector<std::string>& makers)
+{
+    // The walk updateInterfaces() does: every interface and property,
+    // merged against the sorted interface ops.
+    auto iterate = measure([&]() {
+        std::size_t n = 0;
+        auto opsit = makers.cbegin();
+        for (const auto& [iface, props] : object)
+        {
+            opsit = std::lower_bound(opsit, makers.cend(), iface);
+            for (const auto& p : props)
+            {
+                n += p.second.index();
+            }
+        }
+        return n + (opsit - makers.cbegin());
+    });
+
+    // The lookups conditionMatch() does.
+    const std::string property{"Property5"};
+    auto lookup = measure([&]() {
+        std::size_t n = 0;
+        for (const auto& m : makers)
+        {
+            if (auto iface = object.find(m); iface != object.end())
+            {
+                n += iface->second.find(property)->second.index();
+            }
+        }
+        return n;
+    });
+
+    std::cout << name << ": iterate " << iterate << " ns, lookup " << lookup
+              << " ns\n";
+}
+} // namespace
+
+int main()
+{
+    std::vector<std::string> makers;
+    for (auto i = 0; i < interfaces * 4; ++i)
+    {
+        makers.push_back("xyz.openbmc_project.Inventory.Decorator" +
+                         std::to_string(i));
+    }
+    std::sort(makers.begin(), makers.end());
+
+    std::cout << interfaces << " interfaces, " << properties
+              << " properties each\n";
+    report("std::map", makeObject<MapObject<InterfaceVariantType>>(), makers);
+    report("FlatMap", makeObject<Object>(), makers);
+
+    return 0;
+}
@@ -1,10 +1,39 @@
 #include "../utils.hpp"
 
+#include <cstdlib>
+#include <map>
+#include <new>
+
 #include <gtest/gtest.h>
 
 using namespace phosphor::inventory::manager;
 using namespace std::string_literals;
 
+namespace
+{
+std::size_t allocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 TEST(UtilsTest, TestVariantVisitor)
 {
     std::variant<int, std::string> ib1(100);
@@ -16,6 +45,19 @@ TEST(UtilsTest, TestVariantVisitor)
                  std::runtime_error);
 }
 
+TEST(UtilsTest, TestVariantVisitorMove)
+{
+    std::variant<int, std::vector<uint8_t>> v1(std::vector<uint8_t>(4096));
+    const auto* data = std::get<std::vector<uint8_t>>(v1).data();
+
+    auto copied = convertVariant<std::variant<std::vector<uint8_t>>>(v1);
+    EXPECT_NE(std::get<std::vector<uint8_t>>(copied).data(), data);
+
+    auto moved =
+        convertVariant<std::variant<std::vector<uint8_t>>>(std::move(v1));
+    EXPECT_EQ(std::get<std::vector<uint8_t>>(moved).data(), data);
+}
+
 TEST(UtilsTest, TestCompareFirst)
 {
     auto c = compareFirst(std::less<int>());
@@ -95,3 +137,125 @@ TEST(UtilsTest, TestRelPathCompareNoPrefix)
     EXPECT_FALSE(comp(s8, s7));
     EXPECT_TRUE(comp(s7, s8));
 }
+
+TEST(UtilsTest, TestPathCompareRooted)
+{
+    PathCompare comp;
+    RootedPath p{"/root", "/b"};
+
+    EXPECT_TRUE(comp("/root/a"s, p));
+    EXPECT_FALSE(comp(p, "/root/a"s));
+
+    EXPECT_FALSE(comp("/root/b"s, p));
+    EXPECT_FALSE(comp(p, "/root/b"s));
+    EXPECT_EQ(PathCompare::compare("/root/b", p), 0);
+
+    EXPECT_FALSE(comp("/root/c"s, p));
+    EXPECT_TRUE(comp(p, "/root/c"s));
+
+    EXPECT_FALSE(comp("/root/b/c"s, p));
+    EXPECT_TRUE(comp(p, "/root/b/c"s));
+
+    // Shorter than the prefix.
+    EXPECT_TRUE(comp("/ro"s, p));
+    EXPECT_TRUE(comp("/root"s, p));
+
+    // Differs within the prefix.
+    EXPECT_FALSE(comp("/rooz"s, p));
+    EXPECT_TRUE(comp(p, "/rooz"s));
+    EXPECT_TRUE(comp("/rooa/z"s, p));
+}
+
+TEST(UtilsTest, TestPathLookupDoesNotAllocate)
+{
+    // Long enough paths to defeat the small string optimization.
+    const auto root = "/xyz/openbmc_project/inventory"s;
+    std::map<std::string, int, PathCompare> refs;
+    for (auto i = 0; i < 64; ++i)
+    {
+        refs.emplace(root + "/system/chassis/motherboard/cpu" +
+                         std::to_string(i),
+                     i);
+    }
+    const auto rel = "/system/chassis/motherboard/cpu42"s;
+    const auto missing = "/system/chassis/motherboard/cpu420"s;
+    const auto other = root + "/system/chassis/motherboard/cpu7";
+    RelPathCompare relComp(root);
+
+    auto before = allocations;
+
+    auto found = refs.find(RootedPath{root, rel});
+    auto notFound = refs.find(RootedPath{root, missing});
+    auto insertAt = refs.lower_bound(RootedPath{root, missing});
+    auto less = relComp(found->first, other);
+
+    EXPECT_EQ(allocations, before);
+
+    ASSERT_NE(found, refs.end());
+    EXPECT_EQ(found->second, 42);
+    EXPECT_EQ(notFound, refs.end());
+    ASSERT_NE(insertAt, refs.end());
+    EXPECT_EQ(insertAt->second, 43);
+    EXPECT_TRUE(less);
+}
+
+TEST(UtilsTest, TestFlatMapOrder)
+{
+    FlatMap<std::string, int> m{{"b", 2}, {"a", 1}, {"c", 3}, {"a", 4}};
+
+    ASSERT_EQ(m.size(), 3);
+    EXPECT_EQ(m.begin()->first, "a");
+    EXPECT_EQ(m.begin()->second, 1);
+    EXPECT_EQ(std::prev(m.end())->first, "c");
+
+    auto [it, inserted] = m.emplace("bb", 5);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(std::next(it)->first, "c");
+
+    std::tie(it, inserted) = m.emplace("b", 6);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it->second, 2);
+
+    std::tie(it, inserted) = m.emplace("d", 7);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(std::next(it), m.end());
+
+    std::vector<std::string> keys;
+    for (const auto& [k, v] : m)
+    {
+        keys.push_back(k);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"a", "b", "bb", "c", "d"}));
+}
+
+TEST(UtilsTest, TestFlatMapLookup)
+{
+    FlatMap<std::string, int> m{{"foo", 1}, {"bar", 2}};
+
+    EXPECT_EQ(m.find("foo")->second, 1);
+    EXPECT_EQ(m.find(std::string_view{"bar"})->second, 2);
+    EXPECT_EQ(m.find("baz"), m.end());
+    EXPECT_TRUE(m.contains("bar"));
+    EXPECT_FALSE(m.contains("fo"));
+
+    m["baz"] = 3;
+    EXPECT_EQ(m.find("baz")->second, 3);
+    m["foo"] = 4;
+    EXPECT_EQ(m.find("foo")->second, 4);
+
+    EXPECT_EQ(m.erase("bar"), 1);
+    EXPECT_EQ(m.erase("bar"), 0);
+    EXPECT_EQ(m, (FlatMap<std::string, int>{{"baz", 3}, {"foo", 4}}));
+}
+
+TEST(UtilsTest, TestQueueAdmits)
+{
+    EXPECT_TRUE(queueAdmits(0, 3, 4));
+    EXPECT_TRUE(queueAdmits(1, 3, 4));
+    EXPECT_FALSE(queueAdmits(2, 3, 4));
+    EXPECT_FALSE(queueAdmits(4, 1, 4));
+
+    // A batch larger than the limit is taken once the queue has drained.
+    EXPECT_FALSE(queueAdmits(1, 10, 4));
+    EXPECT_TRUE(queueAdmits(0, 10, 4));
+}
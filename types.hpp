@@ -1,5 +1,8 @@
 #pragma once
 
+#include "coroutine.hpp"
+#include "utils.hpp"
+
 #include <sdbusplus/bus.hpp>
 #include <sdbusplus/message.hpp>
 #include <sdbusplus/message/types.hpp>
@@ -24,19 +27,24 @@ using InterfaceVariantType =
                  std::vector<uint8_t>, std::vector<std::string>>;
 
 template <typename T>
-using InterfaceType = std::map<std::string, T>;
+using InterfaceType = FlatMap<std::string, T>;
 
 template <typename T>
-using ObjectType = std::map<std::string, InterfaceType<T>>;
+using ObjectType = FlatMap<std::string, InterfaceType<T>>;
 
 using Interface = InterfaceType<InterfaceVariantType>;
 using Object = ObjectType<InterfaceVariantType>;
 
-using Action = std::function<void(sdbusplus::bus_t&, Manager&)>;
-using Filter =
-    std::function<bool(sdbusplus::bus_t&, sdbusplus::message_t&, Manager&)>;
+/** @brief Objects as decoded by the Manager binding's Notify method. */
+using NotifyObjects = std::map<
+    sdbusplus::object_path,
+    std::map<std::string, std::map<std::string, InterfaceVariantType>>>;
+
+using Action = std::function<Task<>(sdbusplus::bus_t&, Manager&)>;
+using Filter = std::function<Task<bool>(sdbusplus::bus_t&,
+                                        sdbusplus::message_t&, Manager&)>;
 using PathCondition =
-    std::function<bool(const std::string&, sdbusplus::bus_t&, Manager&)>;
+    std::function<Task<bool>(const std::string&, sdbusplus::bus_t&, Manager&)>;
 template <typename T>
 using GetProperty = std::function<T(Manager&)>;
 } // namespace manager
@@ -2,11 +2,17 @@
 
 #include <sdbusplus/message/native_types.hpp>
 
-#include <cstring>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace phosphor
 {
@@ -100,11 +106,13 @@ struct MakeVariantVisitor
     template <typename Arg>
     auto operator()(Arg&& arg) const
     {
-        return Make<V, Arg>::make(arg);
+        return Make<V, Arg>::make(std::forward<Arg>(arg));
     }
 };
 
 /** @brief Convert variants with different contained types.
+ *
+ *  The contained value is moved into the result when v is an rvalue.
  *
  *  @tparam V - The desired variant type.
  *  @tparam Arg - The source variant type.
@@ -115,7 +123,7 @@ struct MakeVariantVisitor
 template <typename V, typename Arg>
 auto convertVariant(Arg&& v)
 {
-    return std::visit(MakeVariantVisitor<V>(), v);
+    return std::visit(MakeVariantVisitor<V>(), std::forward<Arg>(v));
 }
 
 /** @struct CompareFirst
@@ -208,17 +216,19 @@ struct RelPathCompare
      *
      *  @param[in] p - The prefix to check for and remove.
      */
-    explicit RelPathCompare(const char* p) : prefix(p) {}
+    explicit RelPathCompare(std::string_view p) : prefix(p) {}
 
     /** @brief Check for the prefix and remove if found.
      *
      *  @param[in] s - The string to check for and remove prefix from.
+     *
+     *  @returns - A view of s without the prefix.
      */
-    auto relPath(const std::string& s) const
+    std::string_view relPath(std::string_view s) const
     {
-        if (s.find(prefix) == 0)
+        if (s.starts_with(prefix))
         {
-            return s.substr(strlen(prefix));
+            s.remove_prefix(prefix.size());
         }
 
         return s;
@@ -231,13 +241,263 @@ struct RelPathCompare
      *
      *  @returns - The result of the comparison.
      */
-    bool operator()(const std::string& l, const std::string& r) const
+    bool operator()(std::string_view l, std::string_view r) const
     {
         return relPath(l) < relPath(r);
     }
 
     /* The path prefix to remove when comparing two paths. */
-    const char* prefix;
+    std::string_view prefix;
+};
+
+/** @struct RootedPath
+ *  @brief A path relative to a prefix, kept apart from the prefix.
+ */
+struct RootedPath
+{
+    /* The path prefix. */
+    std::string_view prefix;
+
+    /* The path, relative to the prefix. */
+    std::string_view path;
+};
+
+/** @struct PathCompare
+ *  @brief Transparent comparison of absolute and rooted paths.
+ *
+ *  A RootedPath compares as if its prefix and path were concatenated,
+ *  so containers keyed by absolute paths can be searched with a relative
+ *  path without building the absolute path.
+ */
+struct PathCompare
+{
+    using is_transparent = void;
+
+    /** @brief Three-way comparison of an absolute and a rooted path.
+     *
+     *  @param[in] l - The absolute path.
+     *  @param[in] r - The rooted path.
+     *
+     *  @returns - Less than, equal to or greater than zero as l sorts
+     *      before, with or after the concatenation of r.
+     */
+    static int compare(std::string_view l, const RootedPath& r)
+    {
+        if (auto c = l.substr(0, r.prefix.size()).compare(r.prefix); c != 0)
+        {
+            return c;
+        }
+
+        return l.substr(r.prefix.size()).compare(r.path);
+    }
+
+    bool operator()(std::string_view l, std::string_view r) const
+    {
+        return l < r;
+    }
+
+    bool operator()(std::string_view l, const RootedPath& r) const
+    {
+        return compare(l, r) < 0;
+    }
+
+    bool operator()(const RootedPath& l, std::string_view r) const
+    {
+        return compare(r, l) > 0;
+    }
+};
+
+/** @brief Whether a bounded queue takes a batch of new entries.
+ *
+ *  A batch is refused if it would take the queue past its limit, unless
+ *  the queue is empty, so a batch larger than the limit is not refused
+ *  forever.
+ *
+ *  @param[in] queued - The number of entries in the queue.
+ *  @param[in] added - The number of entries the batch adds.
+ *  @param[in] limit - The queue limit.
+ */
+constexpr bool queueAdmits(std::size_t queued, std::size_t added,
+                           std::size_t limit)
+{
+    return queued == 0 || queued + added <= limit;
+}
+
+/** @class FlatMap
+ *  @brief An associative container kept as a sorted vector.
+ *
+ *  The inventory transport types hold a handful of entries each and
+ *  are mostly iterated, so contiguous storage beats a node based map.
+ *  Like std::map, value_type is a key/value pair and emplace() does not
+ *  replace an existing key, which is enough for sdbusplus to read and
+ *  append it as a D-Bus dictionary.  Unlike std::map, emplace()
+ *  invalidates iterators, and keys must not be modified in place.
+ *
+ *  @tparam K - The key type.
+ *  @tparam V - The mapped type.
+ */
+template <typename K, typename V>
+class FlatMap
+{
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using container_type = std::vector<value_type>;
+    using size_type = typename container_type::size_type;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+    FlatMap() = default;
+
+    /** @brief Construct a FlatMap from a list of entries.
+     *
+     *  If a key is repeated the first entry is kept, as with std::map.
+     *
+     *  @param[in] init - The entries.
+     */
+    FlatMap(std::initializer_list<value_type> init) : _entries(init)
+    {
+        std::stable_sort(_entries.begin(), _entries.end(),
+                         compareFirst(std::less<>()));
+        _entries.erase(std::unique(_entries.begin(), _entries.end(),
+                                   [](const auto& l, const auto& r) {
+                                       return l.first == r.first;
+                                   }),
+                       _entries.end());
+    }
+
+    iterator begin() noexcept
+    {
+        return _entries.begin();
+    }
+    const_iterator begin() const noexcept
+    {
+        return _entries.begin();
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return _entries.cbegin();
+    }
+    iterator end() noexcept
+    {
+        return _entries.end();
+    }
+    const_iterator end() const noexcept
+    {
+        return _entries.end();
+    }
+    const_iterator cend() const noexcept
+    {
+        return _entries.cend();
+    }
+
+    bool empty() const noexcept
+    {
+        return _entries.empty();
+    }
+    size_type size() const noexcept
+    {
+        return _entries.size();
+    }
+    void reserve(size_type n)
+    {
+        _entries.reserve(n);
+    }
+    void clear() noexcept
+    {
+        _entries.clear();
+    }
+
+    /** @brief Find the first entry not ordered before a key. */
+    template <typename Key>
+    iterator lower_bound(const Key& key)
+    {
+        return std::lower_bound(_entries.begin(), _entries.end(), key,
+                                compareFirst(std::less<>()));
+    }
+    template <typename Key>
+    const_iterator lower_bound(const Key& key) const
+    {
+        return std::lower_bound(_entries.begin(), _entries.end(), key,
+                                compareFirst(std::less<>()));
+    }
+
+    /** @brief Find the entry with a key, or end(). */
+    template <typename Key>
+    iterator find(const Key& key)
+    {
+        auto it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+    template <typename Key>
+    const_iterator find(const Key& key) const
+    {
+        auto it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    template <typename Key>
+    bool contains(const Key& key) const
+    {
+        return find(key) != end();
+    }
+
+    /** @brief Insert an entry unless its key is already present.
+     *
+     *  Entries arriving in key order are appended without a search.
+     *
+     *  @returns - The entry with the key and whether it was inserted.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type entry(std::forward<Args>(args)...);
+        if (_entries.empty() || _entries.back().first < entry.first)
+        {
+            _entries.push_back(std::move(entry));
+            return {std::prev(_entries.end()), true};
+        }
+
+        auto it = lower_bound(entry.first);
+        if (it->first == entry.first)
+        {
+            return {it, false};
+        }
+        return {_entries.insert(it, std::move(entry)), true};
+    }
+
+    V& operator[](const K& key)
+    {
+        auto it = lower_bound(key);
+        if (it == end() || it->first != key)
+        {
+            it = _entries.emplace(it, key, V{});
+        }
+        return it->second;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return _entries.erase(pos);
+    }
+
+    template <typename Key>
+    size_type erase(const Key& key)
+    {
+        auto it = find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        _entries.erase(it);
+        return 1;
+    }
+
+    friend bool operator==(const FlatMap&, const FlatMap&) = default;
+
+  private:
+    container_type _entries;
 };
 } // namespace manager
 } // namespace inventory